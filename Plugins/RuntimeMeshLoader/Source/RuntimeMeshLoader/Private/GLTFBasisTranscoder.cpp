@@ -0,0 +1,8 @@
+#include "CoreMinimal.h"
+
+// The Basis Universal transcoder is a single source file, built as part of the module
+#if WITH_BASIS_TRANSCODER
+THIRD_PARTY_INCLUDES_START
+#include "basisu_transcoder.cpp"
+THIRD_PARTY_INCLUDES_END
+#endif
@@ -0,0 +1,540 @@
+#include "GLTFBlockCompression.h"
+
+namespace
+{
+	using GLTFBlockCompression::EQuality;
+
+	FORCEINLINE int32 ColorDistance(int32 R0, int32 G0, int32 B0, int32 R1, int32 G1, int32 B1)
+	{
+		return (R0 - R1) * (R0 - R1) + (G0 - G1) * (G0 - G1) + (B0 - B1) * (B0 - B1);
+	}
+
+	FORCEINLINE void WriteUInt16(uint8* Out, uint32 Value)
+	{
+		Out[0] = (uint8)(Value & 0xff);
+		Out[1] = (uint8)(Value >> 8);
+	}
+
+	/* BC1 */
+
+	FORCEINLINE uint32 To565(const FVector& Color)
+	{
+		const int32 R = FMath::Clamp(FMath::RoundToInt(Color.X * 31.0f / 255.0f), 0, 31);
+		const int32 G = FMath::Clamp(FMath::RoundToInt(Color.Y * 63.0f / 255.0f), 0, 63);
+		const int32 B = FMath::Clamp(FMath::RoundToInt(Color.Z * 31.0f / 255.0f), 0, 31);
+		return (R << 11) | (G << 5) | B;
+	}
+
+	FORCEINLINE void From565(uint32 Color, int32& R, int32& G, int32& B)
+	{
+		R = (Color >> 11) & 31;
+		G = (Color >> 5) & 63;
+		B = Color & 31;
+		R = (R << 3) | (R >> 2);
+		G = (G << 2) | (G >> 4);
+		B = (B << 3) | (B >> 2);
+	}
+
+	// Picks the nearest of the four palette entries for every texel, returns the summed error
+	int32 FindBC1Indices(const FColor* Texels, uint32 Color0, uint32 Color1, uint32& OutIndices)
+	{
+		int32 Palette[4][3];
+		From565(Color0, Palette[0][0], Palette[0][1], Palette[0][2]);
+		From565(Color1, Palette[1][0], Palette[1][1], Palette[1][2]);
+		for (int32 c = 0; c < 3; ++c)
+		{
+			Palette[2][c] = (2 * Palette[0][c] + Palette[1][c]) / 3;
+			Palette[3][c] = (Palette[0][c] + 2 * Palette[1][c]) / 3;
+		}
+
+		int32 Error = 0;
+		OutIndices = 0;
+		for (int32 i = 0; i < 16; ++i)
+		{
+			int32 BestIndex = 0;
+			int32 BestDistance = MAX_int32;
+			for (int32 p = 0; p < 4; ++p)
+			{
+				const int32 Distance = ColorDistance(Texels[i].R, Texels[i].G, Texels[i].B, Palette[p][0], Palette[p][1], Palette[p][2]);
+				if (Distance < BestDistance)
+				{
+					BestDistance = Distance;
+					BestIndex = p;
+				}
+			}
+			OutIndices |= BestIndex << (i * 2);
+			Error += BestDistance;
+		}
+		return Error;
+	}
+
+	// Orders the endpoints for the four color mode and quantizes them, returns the block error
+	int32 QuantizeBC1(const FColor* Texels, const FVector& End0, const FVector& End1, uint32& OutColor0, uint32& OutColor1, uint32& OutIndices)
+	{
+		OutColor0 = To565(End0);
+		OutColor1 = To565(End1);
+		if (OutColor0 < OutColor1)
+		{
+			Swap(OutColor0, OutColor1);
+		}
+		if (OutColor0 == OutColor1)
+		{
+			// Three color mode would kick in, index 0 alone reproduces the block just as well
+			int32 R, G, B;
+			From565(OutColor0, R, G, B);
+			int32 Error = 0;
+			for (int32 i = 0; i < 16; ++i)
+			{
+				Error += ColorDistance(Texels[i].R, Texels[i].G, Texels[i].B, R, G, B);
+			}
+			OutIndices = 0;
+			return Error;
+		}
+		return FindBC1Indices(Texels, OutColor0, OutColor1, OutIndices);
+	}
+
+	// Least squares endpoints for the current indices, as in the usual cluster fit refinement
+	bool RefineBC1(const FColor* Texels, uint32 Color0, uint32 Color1, uint32 Indices, FVector& OutEnd0, FVector& OutEnd1)
+	{
+		static const float Weights[4] = { 1.0f, 0.0f, 2.0f / 3.0f, 1.0f / 3.0f };
+		if (Color0 == Color1) return false;
+
+		float AA = 0.0f, BB = 0.0f, AB = 0.0f;
+		FVector AX = FVector::ZeroVector, BX = FVector::ZeroVector;
+		for (int32 i = 0; i < 16; ++i)
+		{
+			const float Alpha = Weights[(Indices >> (i * 2)) & 3];
+			const float Beta = 1.0f - Alpha;
+			const FVector X(Texels[i].R, Texels[i].G, Texels[i].B);
+			AA += Alpha * Alpha;
+			BB += Beta * Beta;
+			AB += Alpha * Beta;
+			AX += X * Alpha;
+			BX += X * Beta;
+		}
+
+		const float Determinant = AA * BB - AB * AB;
+		if (FMath::Abs(Determinant) < KINDA_SMALL_NUMBER) return false;
+		OutEnd0 = (AX * BB - BX * AB) / Determinant;
+		OutEnd1 = (BX * AA - AX * AB) / Determinant;
+		return true;
+	}
+
+	void EncodeBC1Block(const FColor* Texels, uint8* OutBlock, EQuality Quality)
+	{
+		FVector Mean = FVector::ZeroVector;
+		FVector Min(255.0f), Max(0.0f);
+		for (int32 i = 0; i < 16; ++i)
+		{
+			const FVector Color(Texels[i].R, Texels[i].G, Texels[i].B);
+			Mean += Color / 16.0f;
+			Min = Min.ComponentMin(Color);
+			Max = Max.ComponentMax(Color);
+		}
+
+		FVector End0, End1;
+		if (Quality == EQuality::Fast)
+		{
+			// Bounding box diagonal, flipped along the axes that correlate negatively with green
+			float CovRG = 0.0f, CovBG = 0.0f;
+			for (int32 i = 0; i < 16; ++i)
+			{
+				CovRG += (Texels[i].R - Mean.X) * (Texels[i].G - Mean.Y);
+				CovBG += (Texels[i].B - Mean.Z) * (Texels[i].G - Mean.Y);
+			}
+			const FVector Inset = (Max - Min) / 16.0f;
+			End0 = Max - Inset;
+			End1 = Min + Inset;
+			if (CovRG < 0.0f) Swap(End0.X, End1.X);
+			if (CovBG < 0.0f) Swap(End0.Z, End1.Z);
+		}
+		else
+		{
+			// Principal axis by power iteration on the covariance, endpoints at the extreme projections
+			float Cov[6] = {};
+			for (int32 i = 0; i < 16; ++i)
+			{
+				const FVector D = FVector(Texels[i].R, Texels[i].G, Texels[i].B) - Mean;
+				Cov[0] += D.X * D.X; Cov[1] += D.X * D.Y; Cov[2] += D.X * D.Z;
+				Cov[3] += D.Y * D.Y; Cov[4] += D.Y * D.Z; Cov[5] += D.Z * D.Z;
+			}
+			FVector Axis = Max - Min;
+			for (int32 Iteration = 0; Iteration < 4; ++Iteration)
+			{
+				Axis = FVector(Cov[0] * Axis.X + Cov[1] * Axis.Y + Cov[2] * Axis.Z,
+					Cov[1] * Axis.X + Cov[3] * Axis.Y + Cov[4] * Axis.Z,
+					Cov[2] * Axis.X + Cov[4] * Axis.Y + Cov[5] * Axis.Z);
+				Axis = Axis.GetSafeNormal();
+			}
+			if (Axis.IsNearlyZero())
+			{
+				Axis = FVector(1.0f, 1.0f, 1.0f).GetUnsafeNormal();
+			}
+
+			float MinProjection = MAX_flt, MaxProjection = -MAX_flt;
+			for (int32 i = 0; i < 16; ++i)
+			{
+				const float Projection = FVector::DotProduct(FVector(Texels[i].R, Texels[i].G, Texels[i].B) - Mean, Axis);
+				MinProjection = FMath::Min(MinProjection, Projection);
+				MaxProjection = FMath::Max(MaxProjection, Projection);
+			}
+			End0 = Mean + Axis * MaxProjection;
+			End1 = Mean + Axis * MinProjection;
+		}
+
+		uint32 Color0, Color1, Indices;
+		int32 Error = QuantizeBC1(Texels, End0, End1, Color0, Color1, Indices);
+
+		const int32 NumRefinements = Quality == EQuality::High ? 2 : 0;
+		for (int32 Iteration = 0; Iteration < NumRefinements && Error > 0; ++Iteration)
+		{
+			FVector Refined0, Refined1;
+			if (!RefineBC1(Texels, Color0, Color1, Indices, Refined0, Refined1)) break;
+
+			uint32 NewColor0, NewColor1, NewIndices;
+			const int32 NewError = QuantizeBC1(Texels, Refined0, Refined1, NewColor0, NewColor1, NewIndices);
+			if (NewError >= Error) break;
+			Error = NewError;
+			Color0 = NewColor0;
+			Color1 = NewColor1;
+			Indices = NewIndices;
+		}
+
+		WriteUInt16(OutBlock, Color0);
+		WriteUInt16(OutBlock + 2, Color1);
+		WriteUInt16(OutBlock + 4, Indices & 0xffff);
+		WriteUInt16(OutBlock + 6, Indices >> 16);
+	}
+
+	/* BC4 */
+
+	// Eight value mode between the channel's extremes
+	void EncodeBC4Channel(const uint8* Values, int32 Stride, uint8* OutBlock)
+	{
+		int32 Min = 255, Max = 0;
+		for (int32 i = 0; i < 16; ++i)
+		{
+			Min = FMath::Min<int32>(Min, Values[i * Stride]);
+			Max = FMath::Max<int32>(Max, Values[i * Stride]);
+		}
+
+		OutBlock[0] = (uint8)Max;
+		OutBlock[1] = (uint8)Min;
+		uint64 Indices = 0;
+		if (Max > Min)
+		{
+			int32 Palette[8];
+			Palette[0] = Max;
+			Palette[1] = Min;
+			for (int32 p = 1; p < 7; ++p)
+			{
+				Palette[p + 1] = ((7 - p) * Max + p * Min + 3) / 7;
+			}
+			for (int32 i = 0; i < 16; ++i)
+			{
+				int32 BestIndex = 0;
+				int32 BestDistance = MAX_int32;
+				for (int32 p = 0; p < 8; ++p)
+				{
+					const int32 Distance = FMath::Abs(Values[i * Stride] - Palette[p]);
+					if (Distance < BestDistance)
+					{
+						BestDistance = Distance;
+						BestIndex = p;
+					}
+				}
+				Indices |= (uint64)BestIndex << (i * 3);
+			}
+		}
+		for (int32 Byte = 0; Byte < 6; ++Byte)
+		{
+			OutBlock[2 + Byte] = (uint8)(Indices >> (Byte * 8));
+		}
+	}
+
+	/* ETC1 */
+
+	const int32 ETCModifiers[8][2] =
+	{
+		{ 2, 8 }, { 5, 17 }, { 9, 29 }, { 13, 42 }, { 18, 60 }, { 24, 80 }, { 33, 106 }, { 47, 183 }
+	};
+
+	// Index bits as stored: 0 +small, 1 +large, 2 -small, 3 -large
+	FORCEINLINE int32 ETCModifier(int32 Table, int32 Index)
+	{
+		const int32 Magnitude = ETCModifiers[Table][Index & 1];
+		return Index & 2 ? -Magnitude : Magnitude;
+	}
+
+	struct FETCSubBlock
+	{
+		int32 Table = 0;
+		int32 Error = MAX_int32;
+		uint8 Indices[8];
+	};
+
+	// Best table and per texel modifiers for eight texels around Base
+	void FitETCSubBlock(const FColor* const* Texels, const int32 Base[3], FETCSubBlock& OutSubBlock)
+	{
+		for (int32 Table = 0; Table < 8; ++Table)
+		{
+			int32 Error = 0;
+			uint8 Indices[8];
+			for (int32 i = 0; i < 8 && Error < OutSubBlock.Error; ++i)
+			{
+				int32 BestDistance = MAX_int32;
+				for (int32 Index = 0; Index < 4; ++Index)
+				{
+					const int32 Modifier = ETCModifier(Table, Index);
+					const int32 Distance = ColorDistance(Texels[i]->R, Texels[i]->G, Texels[i]->B,
+						FMath::Clamp(Base[0] + Modifier, 0, 255), FMath::Clamp(Base[1] + Modifier, 0, 255), FMath::Clamp(Base[2] + Modifier, 0, 255));
+					if (Distance < BestDistance)
+					{
+						BestDistance = Distance;
+						Indices[i] = (uint8)Index;
+					}
+				}
+				Error += BestDistance;
+			}
+			if (Error < OutSubBlock.Error)
+			{
+				OutSubBlock.Error = Error;
+				OutSubBlock.Table = Table;
+				FMemory::Memcpy(OutSubBlock.Indices, Indices, sizeof(Indices));
+			}
+		}
+	}
+
+	FORCEINLINE int32 Expand4(int32 Value) { return (Value << 4) | Value; }
+	FORCEINLINE int32 Expand5(int32 Value) { return (Value << 3) | (Value >> 2); }
+
+	// Fits one sub-block with Candidates quantized base colors, Bits wide, keeps the best
+	void FitETCBase(const FColor* const* Texels, const FVector& Average, int32 Bits, bool bSearchBase, int32 OutBase[3], FETCSubBlock& OutSubBlock)
+	{
+		const int32 MaxValue = (1 << Bits) - 1;
+		int32 Quantized[3];
+		for (int32 c = 0; c < 3; ++c)
+		{
+			Quantized[c] = FMath::Clamp(FMath::RoundToInt(Average[c] * MaxValue / 255.0f), 0, MaxValue);
+		}
+
+		// Brighter and darker bases shift which modifiers fit, the best quality also tries them
+		const int32 NumSteps = bSearchBase ? 1 : 0;
+		for (int32 Step = -NumSteps; Step <= NumSteps; ++Step)
+		{
+			int32 Candidate[3];
+			int32 Expanded[3];
+			for (int32 c = 0; c < 3; ++c)
+			{
+				Candidate[c] = FMath::Clamp(Quantized[c] + Step, 0, MaxValue);
+				Expanded[c] = Bits == 4 ? Expand4(Candidate[c]) : Expand5(Candidate[c]);
+			}
+			FETCSubBlock SubBlock;
+			SubBlock.Error = OutSubBlock.Error;
+			FitETCSubBlock(Texels, Expanded, SubBlock);
+			if (SubBlock.Error < OutSubBlock.Error)
+			{
+				OutSubBlock = SubBlock;
+				FMemory::Memcpy(OutBase, Candidate, sizeof(Candidate));
+			}
+		}
+	}
+
+	void EncodeETC1Block(const FColor* Texels, uint8* OutBlock, EQuality Quality)
+	{
+		uint64 BestBlock = 0;
+		int32 BestError = MAX_int32;
+		const bool bSearchBase = Quality == EQuality::High;
+
+		for (int32 Flip = 0; Flip < (Quality == EQuality::Fast ? 1 : 2); ++Flip)
+		{
+			// Flip 0 splits into left and right 2x4 halves, flip 1 into top and bottom 4x2 halves
+			const FColor* Halves[2][8];
+			int32 Positions[2][8];
+			FVector Averages[2] = { FVector::ZeroVector, FVector::ZeroVector };
+			int32 Counts[2] = { 0, 0 };
+			for (int32 Y = 0; Y < 4; ++Y)
+			{
+				for (int32 X = 0; X < 4; ++X)
+				{
+					const int32 Half = Flip ? Y / 2 : X / 2;
+					const FColor& Texel = Texels[Y * 4 + X];
+					Positions[Half][Counts[Half]] = X * 4 + Y;
+					Halves[Half][Counts[Half]++] = &Texel;
+					Averages[Half] += FVector(Texel.R, Texel.G, Texel.B) / 8.0f;
+				}
+			}
+
+			// Individual mode, two 4 bit base colors
+			{
+				int32 Bases[2][3];
+				FETCSubBlock SubBlocks[2];
+				FitETCBase(Halves[0], Averages[0], 4, bSearchBase, Bases[0], SubBlocks[0]);
+				FitETCBase(Halves[1], Averages[1], 4, bSearchBase, Bases[1], SubBlocks[1]);
+				const int32 Error = SubBlocks[0].Error + SubBlocks[1].Error;
+				if (Error < BestError)
+				{
+					BestError = Error;
+					BestBlock = ((uint64)Bases[0][0] << 60) | ((uint64)Bases[1][0] << 56) | ((uint64)Bases[0][1] << 52) | ((uint64)Bases[1][1] << 48)
+						| ((uint64)Bases[0][2] << 44) | ((uint64)Bases[1][2] << 40);
+					BestBlock |= ((uint64)SubBlocks[0].Table << 37) | ((uint64)SubBlocks[1].Table << 34) | ((uint64)Flip << 32);
+					for (int32 Half = 0; Half < 2; ++Half)
+					{
+						for (int32 i = 0; i < 8; ++i)
+						{
+							const int32 Index = SubBlocks[Half].Indices[i];
+							BestBlock |= ((uint64)(Index >> 1) << (16 + Positions[Half][i])) | ((uint64)(Index & 1) << Positions[Half][i]);
+						}
+					}
+				}
+			}
+
+			// Differential mode, a 5 bit base and a 3 bit signed delta, only if the delta fits
+			{
+				int32 Bases[2][3];
+				FETCSubBlock SubBlocks[2];
+				FitETCBase(Halves[0], Averages[0], 5, false, Bases[0], SubBlocks[0]);
+				FitETCBase(Halves[1], Averages[1], 5, false, Bases[1], SubBlocks[1]);
+				bool bFits = true;
+				for (int32 c = 0; c < 3; ++c)
+				{
+					const int32 Delta = Bases[1][c] - Bases[0][c];
+					bFits &= Delta >= -4 && Delta <= 3;
+				}
+				const int32 Error = SubBlocks[0].Error + SubBlocks[1].Error;
+				if (bFits && Error < BestError)
+				{
+					BestError = Error;
+					BestBlock = 0;
+					for (int32 c = 0; c < 3; ++c)
+					{
+						const int32 Shift = 59 - c * 8;
+						BestBlock |= ((uint64)Bases[0][c] << Shift) | ((uint64)((Bases[1][c] - Bases[0][c]) & 7) << (Shift - 3));
+					}
+					BestBlock |= ((uint64)SubBlocks[0].Table << 37) | ((uint64)SubBlocks[1].Table << 34) | (1ull << 33) | ((uint64)Flip << 32);
+					for (int32 Half = 0; Half < 2; ++Half)
+					{
+						for (int32 i = 0; i < 8; ++i)
+						{
+							const int32 Index = SubBlocks[Half].Indices[i];
+							BestBlock |= ((uint64)(Index >> 1) << (16 + Positions[Half][i])) | ((uint64)(Index & 1) << Positions[Half][i]);
+						}
+					}
+				}
+			}
+		}
+
+		for (int32 Byte = 0; Byte < 8; ++Byte)
+		{
+			OutBlock[Byte] = (uint8)(BestBlock >> (56 - Byte * 8));
+		}
+	}
+
+	/* EAC alpha */
+
+	const int32 EACModifiers[16][8] =
+	{
+		{ -3, -6, -9, -15, 2, 5, 8, 14 }, { -3, -7, -10, -13, 2, 6, 9, 12 }, { -2, -5, -8, -13, 1, 4, 7, 12 }, { -2, -4, -6, -13, 1, 3, 5, 12 },
+		{ -3, -6, -8, -12, 2, 5, 7, 11 }, { -3, -7, -9, -11, 2, 6, 8, 10 }, { -4, -7, -8, -11, 3, 6, 7, 10 }, { -3, -5, -8, -11, 2, 4, 7, 10 },
+		{ -2, -6, -8, -10, 1, 5, 7, 9 }, { -2, -5, -8, -10, 1, 4, 7, 9 }, { -2, -4, -8, -10, 1, 3, 7, 9 }, { -2, -5, -7, -10, 1, 4, 6, 9 },
+		{ -3, -4, -7, -10, 2, 3, 6, 9 }, { -1, -2, -3, -10, 0, 1, 2, 9 }, { -4, -6, -8, -9, 3, 5, 7, 8 }, { -3, -5, -7, -9, 2, 4, 6, 8 }
+	};
+
+	void EncodeEACAlphaBlock(const FColor* Texels, uint8* OutBlock, EQuality Quality)
+	{
+		int32 Min = 255, Max = 0;
+		for (int32 i = 0; i < 16; ++i)
+		{
+			Min = FMath::Min<int32>(Min, Texels[i].A);
+			Max = FMath::Max<int32>(Max, Texels[i].A);
+		}
+
+		int32 BestError = MAX_int32;
+		int32 BestBase = Max, BestMultiplier = 1, BestTable = 13;
+		uint64 BestIndices = 0;
+		const int32 Center = (Min + Max + 1) / 2;
+		const int32 Spread = Quality == EQuality::High ? 1 : 0;
+		for (int32 Table = 0; Table < 16 && BestError > 0; ++Table)
+		{
+			const int32 Range = EACModifiers[Table][7] - EACModifiers[Table][3];
+			const int32 Multiplier = FMath::Clamp((Max - Min + Range / 2) / Range, 1, 15);
+			for (int32 BaseStep = -Spread; BaseStep <= Spread; ++BaseStep)
+			{
+				for (int32 MultiplierStep = -Spread; MultiplierStep <= Spread; ++MultiplierStep)
+				{
+					const int32 Base = FMath::Clamp(Center + BaseStep, 0, 255);
+					const int32 TryMultiplier = FMath::Clamp(Multiplier + MultiplierStep, 1, 15);
+					int32 Error = 0;
+					uint64 Indices = 0;
+					for (int32 i = 0; i < 16 && Error < BestError; ++i)
+					{
+						// Column major, the first texel in the top bits
+						const int32 X = i / 4;
+						const int32 Y = i % 4;
+						const int32 Alpha = Texels[Y * 4 + X].A;
+						int32 BestDistance = MAX_int32;
+						int32 BestIndex = 0;
+						for (int32 Index = 0; Index < 8; ++Index)
+						{
+							const int32 Distance = FMath::Abs(Alpha - FMath::Clamp(Base + EACModifiers[Table][Index] * TryMultiplier, 0, 255));
+							if (Distance < BestDistance)
+							{
+								BestDistance = Distance;
+								BestIndex = Index;
+							}
+						}
+						Error += BestDistance * BestDistance;
+						Indices |= (uint64)BestIndex << (45 - i * 3);
+					}
+					if (Error < BestError)
+					{
+						BestError = Error;
+						BestBase = Base;
+						BestMultiplier = TryMultiplier;
+						BestTable = Table;
+						BestIndices = Indices;
+					}
+				}
+			}
+		}
+
+		OutBlock[0] = (uint8)BestBase;
+		OutBlock[1] = (uint8)((BestMultiplier << 4) | BestTable);
+		for (int32 Byte = 0; Byte < 6; ++Byte)
+		{
+			OutBlock[2 + Byte] = (uint8)(BestIndices >> (40 - Byte * 8));
+		}
+	}
+}
+
+namespace GLTFBlockCompression
+{
+	void EncodeBC1(const FColor* Texels, uint8* OutBlock, EQuality Quality)
+	{
+		EncodeBC1Block(Texels, OutBlock, Quality);
+	}
+
+	void EncodeBC3(const FColor* Texels, uint8* OutBlock, EQuality Quality)
+	{
+		EncodeBC4Channel(&Texels[0].A, sizeof(FColor), OutBlock);
+		EncodeBC1Block(Texels, OutBlock + 8, Quality);
+	}
+
+	void EncodeBC5(const FColor* Texels, uint8* OutBlock)
+	{
+		// The image's red channel, which is B when the RGBA bytes are read as FColor
+		EncodeBC4Channel(&Texels[0].B, sizeof(FColor), OutBlock);
+		EncodeBC4Channel(&Texels[0].G, sizeof(FColor), OutBlock + 8);
+	}
+
+	void EncodeETC1(const FColor* Texels, uint8* OutBlock, EQuality Quality)
+	{
+		EncodeETC1Block(Texels, OutBlock, Quality);
+	}
+
+	void EncodeETC2RGBA(const FColor* Texels, uint8* OutBlock, EQuality Quality)
+	{
+		EncodeEACAlphaBlock(Texels, OutBlock, Quality);
+		EncodeETC1Block(Texels, OutBlock + 8, Quality);
+	}
+}
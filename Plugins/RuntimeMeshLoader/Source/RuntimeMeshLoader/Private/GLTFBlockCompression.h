@@ -0,0 +1,28 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GLTFImportOptions.h"
+
+/*
+	CPU encoders for 4x4 texel blocks. Input blocks are 16 FColor texels in row order, the output is the block
+	as the GPU reads it. Every function is thread safe.
+*/
+namespace GLTFBlockCompression
+{
+	typedef EGLTFTextureCompressionQuality EQuality;
+
+	// RGB, 8 bytes (PF_DXT1). Alpha is ignored.
+	void EncodeBC1(const FColor* Texels, uint8* OutBlock, EQuality Quality);
+
+	// RGBA, 16 bytes (PF_DXT5)
+	void EncodeBC3(const FColor* Texels, uint8* OutBlock, EQuality Quality);
+
+	// Red and green of the RGBA bytes (bytes 0 and 1 of each texel), 16 bytes (PF_BC5)
+	void EncodeBC5(const FColor* Texels, uint8* OutBlock);
+
+	// RGB, 8 bytes. Individual and differential modes only, so the block is valid ETC1 and ETC2 (PF_ETC1, PF_ETC2_RGB).
+	void EncodeETC1(const FColor* Texels, uint8* OutBlock, EQuality Quality);
+
+	// RGBA, 16 bytes: an EAC alpha block followed by an ETC1 color block (PF_ETC2_RGBA)
+	void EncodeETC2RGBA(const FColor* Texels, uint8* OutBlock, EQuality Quality);
+}
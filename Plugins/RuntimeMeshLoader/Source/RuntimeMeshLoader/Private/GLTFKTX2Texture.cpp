@@ -0,0 +1,322 @@
+#include "GLTFKTX2Texture.h"
+#include "RenderUtils.h"
+#include "Misc/Compression.h"
+
+THIRD_PARTY_INCLUDES_START
+#include "zstd.h"
+THIRD_PARTY_INCLUDES_END
+
+#if WITH_BASIS_TRANSCODER
+THIRD_PARTY_INCLUDES_START
+#include "basisu_transcoder.h"
+THIRD_PARTY_INCLUDES_END
+#endif
+
+static const uint8 KTX2Identifier[12] = { 0xAB, 0x4B, 0x54, 0x58, 0x20, 0x32, 0x30, 0xBB, 0x0D, 0x0A, 0x1A, 0x0A };
+
+// Identifier, header and index, the level index follows
+static const int64 KTX2HeaderSize = 80;
+
+static const uint32 KTX2SupercompressionNone = 0;
+static const uint32 KTX2SupercompressionBasisLZ = 1;
+static const uint32 KTX2SupercompressionZstd = 2;
+static const uint32 KTX2SupercompressionZLIB = 3;
+
+// VK_FORMAT_UNDEFINED, used by Basis Universal payloads
+static const uint32 VkFormatUndefined = 0;
+
+struct FKTX2Header
+{
+	uint32 VkFormat;
+	uint32 PixelWidth;
+	uint32 PixelHeight;
+	uint32 PixelDepth;
+	uint32 LayerCount;
+	uint32 FaceCount;
+	uint32 LevelCount;
+	uint32 SupercompressionScheme;
+};
+
+struct FKTX2Level
+{
+	uint64 ByteOffset;
+	uint64 ByteLength;
+	uint64 UncompressedByteLength;
+};
+
+template <typename T>
+static T ReadValue(const TArray<uint8>& Data, int64 Offset)
+{
+	T Value;
+	FMemory::Memcpy(&Value, Data.GetData() + Offset, sizeof(T));
+	return Value;
+}
+
+static FKTX2Header ReadHeader(const TArray<uint8>& FileData)
+{
+	FKTX2Header Header;
+	Header.VkFormat = ReadValue<uint32>(FileData, 12);
+	Header.PixelWidth = ReadValue<uint32>(FileData, 20);
+	Header.PixelHeight = ReadValue<uint32>(FileData, 24);
+	Header.PixelDepth = ReadValue<uint32>(FileData, 28);
+	Header.LayerCount = ReadValue<uint32>(FileData, 32);
+	Header.FaceCount = ReadValue<uint32>(FileData, 36);
+	Header.LevelCount = ReadValue<uint32>(FileData, 40);
+	Header.SupercompressionScheme = ReadValue<uint32>(FileData, 44);
+	return Header;
+}
+
+// Engine format for a Vulkan format a KTX2 file can carry, PF_Unknown for the ones the engine has no match for
+static EPixelFormat GetPixelFormat(uint32 VkFormat)
+{
+	switch (VkFormat)
+	{
+	case 37: case 43: return PF_R8G8B8A8; // R8G8B8A8_UNORM, _SRGB
+	case 44: case 50: return PF_B8G8R8A8; // B8G8R8A8_UNORM, _SRGB
+	case 131: case 132: case 133: case 134: return PF_DXT1; // BC1_RGB, BC1_RGBA
+	case 135: case 136: return PF_DXT3; // BC2
+	case 137: case 138: return PF_DXT5; // BC3
+	case 139: case 140: return PF_BC4;
+	case 141: case 142: return PF_BC5;
+	case 143: case 144: return PF_BC6H;
+	case 145: case 146: return PF_BC7;
+	case 147: case 148: return PF_ETC2_RGB; // ETC2_R8G8B8
+	case 151: case 152: return PF_ETC2_RGBA; // ETC2_R8G8B8A8
+	case 157: case 158: return PF_ASTC_4x4;
+	case 165: case 166: return PF_ASTC_6x6;
+	case 171: case 172: return PF_ASTC_8x8;
+	case 179: case 180: return PF_ASTC_10x10;
+	case 183: case 184: return PF_ASTC_12x12;
+	default: return PF_Unknown;
+	}
+}
+
+// Bytes of a SizeX by SizeY image in PixelFormat
+static int64 GetLevelBytes(EPixelFormat PixelFormat, int32 SizeX, int32 SizeY)
+{
+	const FPixelFormatInfo& Info = GPixelFormats[PixelFormat];
+	return (int64)FMath::DivideAndRoundUp(SizeX, Info.BlockSizeX) * FMath::DivideAndRoundUp(SizeY, Info.BlockSizeY) * Info.BlockBytes;
+}
+
+// Copies levels of a payload already in a GPU format, inflating them first if they are Zstandard or ZLIB supercompressed
+static bool LoadGPULevels(const TArray<uint8>& FileData, const FString& ImageName, const FKTX2Header& Header, EPixelFormat& OutPixelFormat, TArray<FGLTFTextureMip>& OutMips)
+{
+	const EPixelFormat PixelFormat = GetPixelFormat(Header.VkFormat);
+	if (PixelFormat == PF_Unknown)
+	{
+		UE_LOG(LogTemp, Error, TEXT("KTX2 image %s has unsupported VkFormat %u"), *ImageName, Header.VkFormat);
+		return false;
+	}
+	if (!GPixelFormats[PixelFormat].Supported)
+	{
+		UE_LOG(LogTemp, Error, TEXT("KTX2 image %s is %s, which this RHI does not support"), *ImageName, GPixelFormats[PixelFormat].Name);
+		return false;
+	}
+	if (Header.PixelWidth % GPixelFormats[PixelFormat].BlockSizeX != 0 || Header.PixelHeight % GPixelFormats[PixelFormat].BlockSizeY != 0)
+	{
+		UE_LOG(LogTemp, Error, TEXT("KTX2 image %s is not a whole number of %s blocks"), *ImageName, GPixelFormats[PixelFormat].Name);
+		return false;
+	}
+	if (Header.SupercompressionScheme != KTX2SupercompressionNone && Header.SupercompressionScheme != KTX2SupercompressionZstd
+		&& Header.SupercompressionScheme != KTX2SupercompressionZLIB)
+	{
+		UE_LOG(LogTemp, Error, TEXT("KTX2 image %s uses unsupported supercompression scheme %u"), *ImageName, Header.SupercompressionScheme);
+		return false;
+	}
+
+	const int32 NumLevels = FMath::Max<int32>(Header.LevelCount, 1);
+	OutMips.SetNum(NumLevels);
+	for (int32 LevelIndex = 0; LevelIndex < NumLevels; ++LevelIndex)
+	{
+		const FKTX2Level Level = ReadValue<FKTX2Level>(FileData, KTX2HeaderSize + LevelIndex * sizeof(FKTX2Level));
+		FGLTFTextureMip& Mip = OutMips[LevelIndex];
+		Mip.SizeX = FMath::Max<int32>(Header.PixelWidth >> LevelIndex, 1);
+		Mip.SizeY = FMath::Max<int32>(Header.PixelHeight >> LevelIndex, 1);
+		const int64 NumBytes = GetLevelBytes(PixelFormat, Mip.SizeX, Mip.SizeY);
+
+		// Compared this way round so offsets near the top of the range cannot wrap past the check
+		if (Level.ByteOffset > (uint64)FileData.Num() || Level.ByteLength > (uint64)FileData.Num() - Level.ByteOffset)
+		{
+			UE_LOG(LogTemp, Error, TEXT("KTX2 image %s is truncated"), *ImageName);
+			return false;
+		}
+		const uint8* LevelData = FileData.GetData() + Level.ByteOffset;
+
+		if (Header.SupercompressionScheme == KTX2SupercompressionZLIB || Header.SupercompressionScheme == KTX2SupercompressionZstd)
+		{
+			// Only single layer 2D images get here, so a level inflates to exactly its size. Anything else is a corrupt
+			// or hostile file, and the length is not trusted for the allocation.
+			if (Level.UncompressedByteLength != (uint64)NumBytes || NumBytes > MAX_int32)
+			{
+				UE_LOG(LogTemp, Error, TEXT("KTX2 image %s has a level whose uncompressed length does not match its size"), *ImageName);
+				return false;
+			}
+			Mip.Data.SetNumUninitialized((int32)NumBytes);
+			const bool bInflated = Header.SupercompressionScheme == KTX2SupercompressionZstd
+				? ZSTD_decompress(Mip.Data.GetData(), Mip.Data.Num(), LevelData, (size_t)Level.ByteLength) == (size_t)NumBytes
+				: FCompression::UncompressMemory(COMPRESS_ZLIB, Mip.Data.GetData(), Mip.Data.Num(), LevelData, (int32)Level.ByteLength);
+			if (!bInflated)
+			{
+				UE_LOG(LogTemp, Error, TEXT("KTX2 image %s failed to inflate"), *ImageName);
+				return false;
+			}
+		}
+		else
+		{
+			if (Level.ByteLength < (uint64)NumBytes)
+			{
+				UE_LOG(LogTemp, Error, TEXT("KTX2 image %s has a level smaller than its size"), *ImageName);
+				return false;
+			}
+			Mip.Data.Append(LevelData, (int32)NumBytes);
+		}
+	}
+
+	OutPixelFormat = PixelFormat;
+	return true;
+}
+
+#if WITH_BASIS_TRANSCODER
+struct FBasisTarget
+{
+	basist::transcoder_texture_format Format;
+	EPixelFormat PixelFormat;
+};
+
+// Transcodes a Basis Universal payload into the first target the RHI and the transcoder support
+static bool TranscodeBasisLevels(const TArray<uint8>& FileData, const FString& ImageName, EPixelFormat& OutPixelFormat, TArray<FGLTFTextureMip>& OutMips)
+{
+	basist::ktx2_transcoder Transcoder;
+	if (!Transcoder.init(FileData.GetData(), FileData.Num()) || !Transcoder.start_transcoding())
+	{
+		UE_LOG(LogTemp, Error, TEXT("KTX2 image %s could not be opened for transcoding"), *ImageName);
+		return false;
+	}
+	const basist::basis_tex_format SourceFormat = Transcoder.get_format();
+	const bool bHasAlpha = Transcoder.get_has_alpha();
+
+	// ETC1S becomes ETC1 exactly and BC1/BC3 cheaply, UASTC becomes ASTC exactly and BC7 nearly so.
+	// Uncompressed is the last resort, and the only one for sizes that are not a whole number of blocks.
+	TArray<FBasisTarget> Targets;
+	if (Transcoder.get_width() % 4 == 0 && Transcoder.get_height() % 4 == 0)
+	{
+		if (SourceFormat == basist::basis_tex_format::cUASTC4x4)
+		{
+			Targets.Add({ basist::transcoder_texture_format::cTFASTC_4x4_RGBA, PF_ASTC_4x4 });
+			Targets.Add({ basist::transcoder_texture_format::cTFBC7_RGBA, PF_BC7 });
+		}
+		if (bHasAlpha)
+		{
+			Targets.Add({ basist::transcoder_texture_format::cTFETC2_RGBA, PF_ETC2_RGBA });
+			Targets.Add({ basist::transcoder_texture_format::cTFBC3_RGBA, PF_DXT5 });
+		}
+		else
+		{
+			Targets.Add({ basist::transcoder_texture_format::cTFETC1_RGB, PF_ETC2_RGB });
+			Targets.Add({ basist::transcoder_texture_format::cTFETC1_RGB, PF_ETC1 });
+			Targets.Add({ basist::transcoder_texture_format::cTFBC1_RGB, PF_DXT1 });
+		}
+		if (SourceFormat == basist::basis_tex_format::cETC1S)
+		{
+			Targets.Add({ basist::transcoder_texture_format::cTFBC7_RGBA, PF_BC7 });
+			Targets.Add({ basist::transcoder_texture_format::cTFASTC_4x4_RGBA, PF_ASTC_4x4 });
+		}
+	}
+	Targets.Add({ basist::transcoder_texture_format::cTFRGBA32, PF_R8G8B8A8 });
+
+	const FBasisTarget* Target = Targets.FindByPredicate([SourceFormat](const FBasisTarget& Candidate)
+	{
+		return GPixelFormats[Candidate.PixelFormat].Supported && basist::basis_is_format_supported(Candidate.Format, SourceFormat);
+	});
+	if (!Target)
+	{
+		UE_LOG(LogTemp, Error, TEXT("KTX2 image %s has no format to transcode to"), *ImageName);
+		return false;
+	}
+
+	const bool bUncompressed = basist::basis_transcoder_format_is_uncompressed(Target->Format);
+	const uint32 BytesPerBlockOrPixel = basist::basis_get_bytes_per_block_or_pixel(Target->Format);
+	const int32 NumLevels = FMath::Max<int32>(Transcoder.get_levels(), 1);
+	OutMips.SetNum(NumLevels);
+	for (int32 LevelIndex = 0; LevelIndex < NumLevels; ++LevelIndex)
+	{
+		basist::ktx2_image_level_info LevelInfo;
+		if (!Transcoder.get_image_level_info(LevelInfo, LevelIndex, 0, 0))
+		{
+			UE_LOG(LogTemp, Error, TEXT("KTX2 image %s has an invalid level %d"), *ImageName, LevelIndex);
+			return false;
+		}
+
+		FGLTFTextureMip& Mip = OutMips[LevelIndex];
+		Mip.SizeX = LevelInfo.m_orig_width;
+		Mip.SizeY = LevelInfo.m_orig_height;
+		const uint32 NumBlocksOrPixels = bUncompressed ? LevelInfo.m_orig_width * LevelInfo.m_orig_height : LevelInfo.m_total_blocks;
+		Mip.Data.SetNumUninitialized(NumBlocksOrPixels * BytesPerBlockOrPixel);
+		if (!Transcoder.transcode_image_level(LevelIndex, 0, 0, Mip.Data.GetData(), NumBlocksOrPixels, Target->Format))
+		{
+			UE_LOG(LogTemp, Error, TEXT("KTX2 image %s failed to transcode level %d"), *ImageName, LevelIndex);
+			return false;
+		}
+	}
+
+	OutPixelFormat = Target->PixelFormat;
+	return true;
+}
+#endif
+
+namespace GLTFKTX2Texture
+{
+	void Initialize()
+	{
+#if WITH_BASIS_TRANSCODER
+		basist::basisu_transcoder_init();
+#endif
+	}
+
+	bool IsKTX2(const TArray<uint8>& FileData)
+	{
+		return FileData.Num() >= (int32)sizeof(KTX2Identifier) && FMemory::Memcmp(FileData.GetData(), KTX2Identifier, sizeof(KTX2Identifier)) == 0;
+	}
+
+	bool LoadKTX2(const TArray<uint8>& FileData, const FString& ImageName, EPixelFormat& OutPixelFormat, TArray<FGLTFTextureMip>& OutMips)
+	{
+		if (!IsKTX2(FileData) || FileData.Num() < KTX2HeaderSize)
+		{
+			UE_LOG(LogTemp, Error, TEXT("Not a KTX2 image: %s"), *ImageName);
+			return false;
+		}
+
+		const FKTX2Header Header = ReadHeader(FileData);
+		const int32 NumLevels = FMath::Max<int32>(Header.LevelCount, 1);
+		if (FileData.Num() < KTX2HeaderSize + NumLevels * (int64)sizeof(FKTX2Level) || Header.PixelWidth == 0 || Header.PixelHeight == 0)
+		{
+			UE_LOG(LogTemp, Error, TEXT("KTX2 image %s has an invalid header"), *ImageName);
+			return false;
+		}
+		// Levels are sized by shifting the base size, which must stay below the bit width
+		if (Header.LevelCount > FMath::FloorLog2(FMath::Max(Header.PixelWidth, Header.PixelHeight)) + 1)
+		{
+			UE_LOG(LogTemp, Error, TEXT("KTX2 image %s declares %u levels, more than a %ux%u image has"), *ImageName, Header.LevelCount, Header.PixelWidth, Header.PixelHeight);
+			return false;
+		}
+		if (Header.PixelDepth > 0 || Header.LayerCount > 1 || Header.FaceCount != 1)
+		{
+			UE_LOG(LogTemp, Error, TEXT("KTX2 image %s is not a 2D texture"), *ImageName);
+			return false;
+		}
+
+		OutMips.Reset();
+		if (Header.VkFormat != VkFormatUndefined)
+		{
+			return LoadGPULevels(FileData, ImageName, Header, OutPixelFormat, OutMips);
+		}
+
+#if WITH_BASIS_TRANSCODER
+		return TranscodeBasisLevels(FileData, ImageName, OutPixelFormat, OutMips);
+#else
+		UE_LOG(LogTemp, Error, TEXT("KTX2 image %s is Basis Universal encoded (%s), which needs the transcoder sources in ThirdParty/basis_universal/transcoder"),
+			*ImageName, Header.SupercompressionScheme == KTX2SupercompressionBasisLZ ? TEXT("ETC1S") : TEXT("UASTC"));
+		return false;
+#endif
+	}
+}
@@ -0,0 +1,823 @@
+#include "GLTFMeshConversion.h"
+#include "HAL/IConsoleManager.h"
+#include "Async/ParallelFor.h"
+
+#include "assimp/mesh.h"
+
+static_assert(sizeof(aiVector3D) == sizeof(FVector), "aiVector3D and FVector must share a layout for bulk copies");
+
+// Row vector convention, same as FMatrix::TransformPosition
+struct FTransformRows
+{
+	VectorRegister Row0;
+	VectorRegister Row1;
+	VectorRegister Row2;
+	VectorRegister Row3;
+
+	FTransformRows(const FMatrix& Matrix, bool bTranslate)
+		: Row0(VectorLoadFloat3_W0(&Matrix.M[0][0]))
+		, Row1(VectorLoadFloat3_W0(&Matrix.M[1][0]))
+		, Row2(VectorLoadFloat3_W0(&Matrix.M[2][0]))
+		, Row3(bTranslate ? VectorLoadFloat3_W0(&Matrix.M[3][0]) : VectorZero())
+	{}
+
+	FORCEINLINE VectorRegister Transform(const VectorRegister& X, const VectorRegister& Y, const VectorRegister& Z) const
+	{
+		return VectorMultiplyAdd(X, Row0, VectorMultiplyAdd(Y, Row1, VectorMultiplyAdd(Z, Row2, Row3)));
+	}
+};
+
+// Normalizes the xyz part of V, zero length vectors stay zero
+static FORCEINLINE VectorRegister NormalizeSafe3(const VectorRegister& V)
+{
+	const VectorRegister LengthSquared = VectorDot3(V, V);
+	const VectorRegister Mask = VectorCompareGT(LengthSquared, VectorSetFloat1(SMALL_NUMBER));
+	return VectorSelect(Mask, VectorMultiply(V, VectorReciprocalSqrtAccurate(LengthSquared)), VectorZero());
+}
+
+static FORCEINLINE bool IsIdentity(const FMatrix& Matrix)
+{
+	return Matrix.Equals(FMatrix::Identity, 0.0f);
+}
+
+template<bool bDirection>
+static void TransformStream(const FMatrix& Matrix, const FVector * Source, FVector * Dest, int32 Num)
+{
+	const FTransformRows Rows(Matrix, !bDirection);
+	const float* Src = reinterpret_cast<const float*>(Source);
+	float* Dst = reinterpret_cast<float*>(Dest);
+
+	// Four packed xyz vertices are exactly three registers
+	int32 i = 0;
+	for (; i + 4 <= Num; i += 4, Src += 12, Dst += 12)
+	{
+		const VectorRegister L0 = VectorLoad(Src);
+		const VectorRegister L1 = VectorLoad(Src + 4);
+		const VectorRegister L2 = VectorLoad(Src + 8);
+
+		VectorRegister R0 = Rows.Transform(VectorReplicate(L0, 0), VectorReplicate(L0, 1), VectorReplicate(L0, 2));
+		VectorRegister R1 = Rows.Transform(VectorReplicate(L0, 3), VectorReplicate(L1, 0), VectorReplicate(L1, 1));
+		VectorRegister R2 = Rows.Transform(VectorReplicate(L1, 2), VectorReplicate(L1, 3), VectorReplicate(L2, 0));
+		VectorRegister R3 = Rows.Transform(VectorReplicate(L2, 1), VectorReplicate(L2, 2), VectorReplicate(L2, 3));
+
+		if (bDirection)
+		{
+			R0 = NormalizeSafe3(R0);
+			R1 = NormalizeSafe3(R1);
+			R2 = NormalizeSafe3(R2);
+			R3 = NormalizeSafe3(R3);
+		}
+
+		// Repack (x0 y0 z0 x1) (y1 z1 x2 y2) (z2 x3 y3 z3)
+		const VectorRegister T0 = VectorShuffle(R0, R1, 2, 2, 0, 0);
+		const VectorRegister T2 = VectorShuffle(R2, R3, 2, 2, 0, 0);
+		VectorStore(VectorShuffle(R0, T0, 0, 1, 0, 2), Dst);
+		VectorStore(VectorShuffle(R1, R2, 1, 2, 0, 1), Dst + 4);
+		VectorStore(VectorShuffle(T2, R3, 0, 2, 1, 2), Dst + 8);
+	}
+
+	for (; i < Num; ++i, Src += 3, Dst += 3)
+	{
+		const VectorRegister L = VectorLoadFloat3(Src);
+		VectorRegister R = Rows.Transform(VectorReplicate(L, 0), VectorReplicate(L, 1), VectorReplicate(L, 2));
+		if (bDirection)
+		{
+			R = NormalizeSafe3(R);
+		}
+		VectorStoreFloat3(R, Dst);
+	}
+}
+
+template<typename IndexType>
+static void FlattenFaces(const aiMesh * Mesh, TArray<IndexType>& OutIndices)
+{
+	const uint32 NumFaces = Mesh->mNumFaces;
+	const aiFace* RESTRICT Faces = Mesh->mFaces;
+
+	// aiProcess_Triangulate leaves pure triangle meshes, every face has exactly three indices
+	if (Mesh->mPrimitiveTypes == aiPrimitiveType_TRIANGLE)
+	{
+		OutIndices.SetNumUninitialized(NumFaces * 3, false);
+		IndexType* RESTRICT Dest = OutIndices.GetData();
+		for (uint32 f = 0; f < NumFaces; ++f, Dest += 3)
+		{
+			const unsigned int* RESTRICT Face = Faces[f].mIndices;
+			Dest[0] = (IndexType)Face[0];
+			Dest[1] = (IndexType)Face[1];
+			Dest[2] = (IndexType)Face[2];
+		}
+		return;
+	}
+
+	// Mixed primitives, keep the triangles only
+	OutIndices.Reset(NumFaces * 3);
+	uint32 NumSkipped = 0;
+	for (uint32 f = 0; f < NumFaces; ++f)
+	{
+		if (Faces[f].mNumIndices != 3)
+		{
+			++NumSkipped;
+			continue;
+		}
+		OutIndices.Add((IndexType)Faces[f].mIndices[0]);
+		OutIndices.Add((IndexType)Faces[f].mIndices[1]);
+		OutIndices.Add((IndexType)Faces[f].mIndices[2]);
+	}
+	if (NumSkipped > 0)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("Skipped %u point/line faces in mesh %s"), NumSkipped, UTF8_TO_TCHAR(Mesh->mName.C_Str()));
+	}
+}
+
+// Vertices per ParallelFor task in the welding passes
+static const int32 WeldChunkSize = 16384;
+
+struct FWeldCell
+{
+	uint64 Key;
+	int32 Vertex;
+};
+
+// 21 bits per axis. Distant cells can wrap onto the same key, which only costs extra comparisons.
+static FORCEINLINE uint64 PackCell(int32 X, int32 Y, int32 Z)
+{
+	return ((uint64)(X & 0x1FFFFF) << 42) | ((uint64)(Y & 0x1FFFFF) << 21) | (uint64)(Z & 0x1FFFFF);
+}
+
+static FORCEINLINE bool CellLess(const FWeldCell& A, const FWeldCell& B)
+{
+	return A.Key < B.Key || (A.Key == B.Key && A.Vertex < B.Vertex);
+}
+
+// Sorts every WeldChunkSize run in parallel, then merges neighbouring runs pairwise, each pass in parallel.
+// Only the last passes have fewer merges than workers.
+static void ParallelSortCells(TArray<FWeldCell>& Cells)
+{
+	const int32 Num = Cells.Num();
+	ParallelFor(FMath::DivideAndRoundUp(Num, WeldChunkSize), [&](int32 Chunk)
+	{
+		const int32 Start = Chunk * WeldChunkSize;
+		Sort(Cells.GetData() + Start, FMath::Min(WeldChunkSize, Num - Start), [](const FWeldCell& A, const FWeldCell& B) { return CellLess(A, B); });
+	});
+	if (Num <= WeldChunkSize) return;
+
+	TArray<FWeldCell> Merged;
+	Merged.SetNumUninitialized(Num);
+	for (int32 RunSize = WeldChunkSize; RunSize < Num; RunSize *= 2)
+	{
+		ParallelFor(FMath::DivideAndRoundUp(Num, 2 * RunSize), [&](int32 Pair)
+		{
+			const int32 Start = Pair * 2 * RunSize;
+			const int32 Mid = FMath::Min(Start + RunSize, Num);
+			const int32 End = FMath::Min(Start + 2 * RunSize, Num);
+			int32 A = Start;
+			int32 B = Mid;
+			for (int32 Out = Start; Out < End; ++Out)
+			{
+				Merged[Out] = (B >= End || (A < Mid && !CellLess(Cells[B], Cells[A]))) ? Cells[A++] : Cells[B++];
+			}
+		});
+		Swap(Cells, Merged);
+	}
+}
+
+// First entry of the sorted cell list with a key not below Key
+static int32 LowerBoundCell(const TArray<FWeldCell>& Cells, uint64 Key)
+{
+	int32 First = 0;
+	int32 Count = Cells.Num();
+	while (Count > 0)
+	{
+		const int32 Step = Count / 2;
+		if (Cells[First + Step].Key < Key)
+		{
+			First += Step + 1;
+			Count -= Step + 1;
+		}
+		else
+		{
+			Count = Step;
+		}
+	}
+	return First;
+}
+
+struct FWeldComparer
+{
+	const FMeshInfo& MeshInfo;
+	float PositionToleranceSquared;
+	float MinDirectionDot;
+	float UVTolerance;
+	bool bNormals;
+	bool bTangents;
+	bool bUV0;
+	bool bUV1;
+	bool bColors;
+
+	FWeldComparer(const FMeshInfo& InMeshInfo, const FGLTFImportOptions& Options)
+		: MeshInfo(InMeshInfo)
+		, PositionToleranceSquared(FMath::Square(Options.WeldPositionTolerance))
+		, MinDirectionDot(FMath::Cos(FMath::DegreesToRadians(Options.WeldNormalToleranceDegrees)))
+		, UVTolerance(Options.WeldUVTolerance)
+	{
+		const int32 NumVertices = MeshInfo.Vertices.Num();
+		bNormals = MeshInfo.Normals.Num() == NumVertices;
+		bTangents = MeshInfo.Tangents.Num() == NumVertices;
+		bUV0 = MeshInfo.UV0.Num() == NumVertices;
+		bUV1 = MeshInfo.UV1.Num() == NumVertices;
+		bColors = MeshInfo.VertexColors.Num() == NumVertices;
+	}
+
+	FORCEINLINE bool Matches(int32 A, int32 B) const
+	{
+		if (FVector::DistSquared(MeshInfo.Vertices[A], MeshInfo.Vertices[B]) > PositionToleranceSquared) return false;
+		if (bNormals && (MeshInfo.Normals[A] | MeshInfo.Normals[B]) < MinDirectionDot) return false;
+		if (bUV0 && !MeshInfo.UV0[A].Equals(MeshInfo.UV0[B], UVTolerance)) return false;
+		if (bUV1 && !MeshInfo.UV1[A].Equals(MeshInfo.UV1[B], UVTolerance)) return false;
+		if (bTangents)
+		{
+			const FProcMeshTangent& TangentA = MeshInfo.Tangents[A];
+			const FProcMeshTangent& TangentB = MeshInfo.Tangents[B];
+			if (TangentA.bFlipTangentY != TangentB.bFlipTangentY || (TangentA.TangentX | TangentB.TangentX) < MinDirectionDot) return false;
+		}
+		if (bColors && !MeshInfo.VertexColors[A].Equals(MeshInfo.VertexColors[B], UVTolerance)) return false;
+		return true;
+	}
+};
+
+// Moves kept vertices to their new slot. NewIndex[i] <= i, so this works in place.
+template<typename ElementType>
+static void CompactStream(TArray<ElementType>& Stream, const TArray<int32>& Remap, const TArray<int32>& NewIndex, int32 NumKept)
+{
+	if (Stream.Num() != Remap.Num()) return;
+	for (int32 i = 0; i < Remap.Num(); ++i)
+	{
+		if (Remap[i] == i)
+		{
+			Stream[NewIndex[i]] = Stream[i];
+		}
+	}
+	Stream.SetNum(NumKept, false);
+}
+
+namespace GLTFMeshConversion
+{
+	void ParallelForMeshes(const aiMesh * const * Meshes, int32 NumMeshes, TFunctionRef<void(int32)> Body, int32 MaxWorkers)
+	{
+		if (NumMeshes <= 0) return;
+
+		TArray<int32> Order;
+		Order.SetNumUninitialized(NumMeshes);
+		for (int32 i = 0; i < NumMeshes; ++i)
+		{
+			Order[i] = i;
+		}
+		Order.StableSort([Meshes](int32 A, int32 B)
+		{
+			return Meshes[A]->mNumVertices + 3 * Meshes[A]->mNumFaces > Meshes[B]->mNumVertices + 3 * Meshes[B]->mNumFaces;
+		});
+
+		// The calling thread takes part in ParallelFor as well
+		const int32 NumAvailable = FTaskGraphInterface::Get().GetNumWorkerThreads() + 1;
+		const int32 NumWorkers = FMath::Clamp(MaxWorkers > 0 ? MaxWorkers : NumAvailable, 1, NumMeshes);
+
+		FThreadSafeCounter NextMesh;
+		ParallelFor(NumWorkers, [&](int32)
+		{
+			for (int32 Slot = NextMesh.Increment() - 1; Slot < NumMeshes; Slot = NextMesh.Increment() - 1)
+			{
+				Body(Order[Slot]);
+			}
+		}, NumWorkers == 1);
+	}
+
+	int32 WeldVertices(FMeshInfo& MeshInfo, const FGLTFImportOptions& Options)
+	{
+		const int32 NumVertices = MeshInfo.Vertices.Num();
+		if (NumVertices < 2 || MeshInfo.Triangles.Num() == 0) return 0;
+
+		// Tolerance is a quarter cell, so only the neighbour on the near side of each axis can hold a match
+		const float CellSize = 4.0f * FMath::Max(Options.WeldPositionTolerance, KINDA_SMALL_NUMBER);
+		const int32 NumChunks = FMath::DivideAndRoundUp(NumVertices, WeldChunkSize);
+
+		TArray<FIntVector> VertexCells;
+		TArray<FWeldCell> SortedCells;
+		VertexCells.SetNumUninitialized(NumVertices);
+		SortedCells.SetNumUninitialized(NumVertices);
+		ParallelFor(NumChunks, [&](int32 Chunk)
+		{
+			const int32 End = FMath::Min((Chunk + 1) * WeldChunkSize, NumVertices);
+			for (int32 i = Chunk * WeldChunkSize; i < End; ++i)
+			{
+				const FVector Scaled = MeshInfo.Vertices[i] / CellSize;
+				const FIntVector Cell(FMath::FloorToInt(Scaled.X), FMath::FloorToInt(Scaled.Y), FMath::FloorToInt(Scaled.Z));
+				VertexCells[i] = Cell;
+				SortedCells[i] = { PackCell(Cell.X, Cell.Y, Cell.Z), i };
+			}
+		});
+		ParallelSortCells(SortedCells);
+
+		// Every vertex points at the lowest index vertex it matches, which keeps the result independent of scheduling
+		const FWeldComparer Comparer(MeshInfo, Options);
+		TArray<int32> Remap;
+		Remap.SetNumUninitialized(NumVertices);
+		ParallelFor(NumChunks, [&](int32 Chunk)
+		{
+			const int32 End = FMath::Min((Chunk + 1) * WeldChunkSize, NumVertices);
+			for (int32 i = Chunk * WeldChunkSize; i < End; ++i)
+			{
+				const FIntVector& Cell = VertexCells[i];
+				const FVector Fraction = MeshInfo.Vertices[i] / CellSize - FVector(Cell);
+
+				int32 Offsets[3][2];
+				int32 NumOffsets[3];
+				for (int32 Axis = 0; Axis < 3; ++Axis)
+				{
+					Offsets[Axis][0] = 0;
+					NumOffsets[Axis] = 1;
+					if (Fraction[Axis] < 0.25f) Offsets[Axis][NumOffsets[Axis]++] = -1;
+					else if (Fraction[Axis] > 0.75f) Offsets[Axis][NumOffsets[Axis]++] = 1;
+				}
+
+				int32 Best = i;
+				for (int32 X = 0; X < NumOffsets[0]; ++X)
+				for (int32 Y = 0; Y < NumOffsets[1]; ++Y)
+				for (int32 Z = 0; Z < NumOffsets[2]; ++Z)
+				{
+					const uint64 Key = PackCell(Cell.X + Offsets[0][X], Cell.Y + Offsets[1][Y], Cell.Z + Offsets[2][Z]);
+					for (int32 j = LowerBoundCell(SortedCells, Key); j < NumVertices && SortedCells[j].Key == Key && SortedCells[j].Vertex < Best; ++j)
+					{
+						if (Comparer.Matches(i, SortedCells[j].Vertex))
+						{
+							Best = SortedCells[j].Vertex;
+							break;
+						}
+					}
+				}
+				Remap[i] = Best;
+			}
+		});
+
+		// Matching is not transitive, follow chains to their root. Remap[i] <= i, so earlier entries are final already.
+		TArray<int32> NewIndex;
+		NewIndex.SetNumUninitialized(NumVertices);
+		int32 NumKept = 0;
+		for (int32 i = 0; i < NumVertices; ++i)
+		{
+			Remap[i] = Remap[Remap[i]];
+			NewIndex[i] = Remap[i] == i ? NumKept++ : NewIndex[Remap[i]];
+		}
+		if (NumKept == NumVertices) return 0;
+
+		CompactStream(MeshInfo.Vertices, Remap, NewIndex, NumKept);
+		CompactStream(MeshInfo.Normals, Remap, NewIndex, NumKept);
+		CompactStream(MeshInfo.UV0, Remap, NewIndex, NumKept);
+		CompactStream(MeshInfo.UV1, Remap, NewIndex, NumKept);
+		CompactStream(MeshInfo.VertexColors, Remap, NewIndex, NumKept);
+		CompactStream(MeshInfo.Tangents, Remap, NewIndex, NumKept);
+
+		TArray<int32>& Triangles = MeshInfo.Triangles;
+		int32 NumIndices = 0;
+		for (int32 t = 0; t + 2 < Triangles.Num(); t += 3)
+		{
+			const int32 A = NewIndex[Triangles[t]];
+			const int32 B = NewIndex[Triangles[t + 1]];
+			const int32 C = NewIndex[Triangles[t + 2]];
+			if (A == B || B == C || A == C) continue;
+			Triangles[NumIndices++] = A;
+			Triangles[NumIndices++] = B;
+			Triangles[NumIndices++] = C;
+		}
+		Triangles.SetNum(NumIndices, false);
+
+		return NumVertices - NumKept;
+	}
+
+	void ComputeHullPoints(const TArray<FVector>& Vertices, int32 MaxPoints, TArray<FVector>& OutPoints)
+	{
+		OutPoints.Reset();
+		if (Vertices.Num() <= MaxPoints)
+		{
+			OutPoints = Vertices;
+			return;
+		}
+
+		// Fibonacci sphere directions
+		const int32 NumDirections = FMath::Max(MaxPoints, 4);
+		const float GoldenAngle = PI * (3.0f - FMath::Sqrt(5.0f));
+		TArray<int32, TInlineAllocator<64>> Extremes;
+		for (int32 d = 0; d < NumDirections; ++d)
+		{
+			const float Z = 1.0f - 2.0f * (d + 0.5f) / NumDirections;
+			const float Radius = FMath::Sqrt(1.0f - Z * Z);
+			const FVector Direction(Radius * FMath::Cos(GoldenAngle * d), Radius * FMath::Sin(GoldenAngle * d), Z);
+
+			int32 Best = 0;
+			float BestDot = Vertices[0] | Direction;
+			for (int32 i = 1; i < Vertices.Num(); ++i)
+			{
+				const float Dot = Vertices[i] | Direction;
+				if (Dot > BestDot)
+				{
+					BestDot = Dot;
+					Best = i;
+				}
+			}
+			Extremes.AddUnique(Best);
+		}
+
+		OutPoints.Reserve(Extremes.Num());
+		for (int32 Index : Extremes)
+		{
+			OutPoints.Add(Vertices[Index]);
+		}
+	}
+
+	FSHAHash ComputeGeometryHash(const FMeshInfo& MeshInfo, uint8 Salt)
+	{
+		FSHA1 Sha;
+		Sha.Update(&Salt, sizeof(Salt));
+		Sha.Update(reinterpret_cast<const uint8*>(MeshInfo.Vertices.GetData()), MeshInfo.Vertices.Num() * sizeof(FVector));
+		Sha.Update(reinterpret_cast<const uint8*>(MeshInfo.Triangles.GetData()), MeshInfo.Triangles.Num() * sizeof(int32));
+		Sha.Update(reinterpret_cast<const uint8*>(MeshInfo.Triangles16.GetData()), MeshInfo.Triangles16.Num() * sizeof(uint16));
+		Sha.Update(reinterpret_cast<const uint8*>(MeshInfo.ConvexHull.GetData()), MeshInfo.ConvexHull.Num() * sizeof(FVector));
+		Sha.Final();
+
+		FSHAHash Hash;
+		Sha.GetHash(Hash.Hash);
+		return Hash;
+	}
+
+	float ComputeACMR(const aiMesh * Mesh, int32 CacheSize)
+	{
+		if (Mesh->mNumFaces == 0) return 0.0f;
+
+		// Vertex is in the cache if it entered less than CacheSize misses ago
+		TArray<int32> EnteredAt;
+		EnteredAt.Init(INDEX_NONE, Mesh->mNumVertices);
+		int32 NumMisses = 0;
+		int32 NumTriangles = 0;
+		for (uint32 f = 0; f < Mesh->mNumFaces; ++f)
+		{
+			const aiFace& Face = Mesh->mFaces[f];
+			if (Face.mNumIndices != 3) continue;
+			++NumTriangles;
+			for (uint32 c = 0; c < 3; ++c)
+			{
+				int32& Entered = EnteredAt[Face.mIndices[c]];
+				if (Entered == INDEX_NONE || NumMisses - Entered >= CacheSize)
+				{
+					Entered = NumMisses++;
+				}
+			}
+		}
+		return NumTriangles > 0 ? (float)NumMisses / NumTriangles : 0.0f;
+	}
+
+	float ComputeACMR(const aiMesh * const * Meshes, int32 NumMeshes, int32 CacheSize)
+	{
+		double WeightedSum = 0.0;
+		int64 NumTriangles = 0;
+		for (int32 i = 0; i < NumMeshes; ++i)
+		{
+			WeightedSum += (double)ComputeACMR(Meshes[i], CacheSize) * Meshes[i]->mNumFaces;
+			NumTriangles += Meshes[i]->mNumFaces;
+		}
+		return NumTriangles > 0 ? (float)(WeightedSum / NumTriangles) : 0.0f;
+	}
+
+	void ConvertIndices(const aiMesh * Mesh, TArray<int32>& OutIndices)
+	{
+		FlattenFaces(Mesh, OutIndices);
+	}
+
+	void ConvertIndices(const aiMesh * Mesh, TArray<uint16>& OutIndices)
+	{
+		check(Mesh->mNumVertices <= MAX_uint16 + 1);
+		FlattenFaces(Mesh, OutIndices);
+	}
+
+	void TransformPositions(const FMatrix& Transform, const FVector * Source, FVector * Dest, int32 Num)
+	{
+		TransformStream<false>(Transform, Source, Dest, Num);
+	}
+
+	void TransformDirections(const FMatrix& Transform, const FVector * Source, FVector * Dest, int32 Num)
+	{
+		TransformStream<true>(Transform, Source, Dest, Num);
+	}
+
+	FMatrix GetNormalMatrix(const FMatrix& Transform)
+	{
+		return Transform.RemoveTranslation().Inverse().GetTransposed();
+	}
+
+	void ConvertVertices(const aiMesh * Mesh, const FMatrix& Transform, FMeshInfo& MeshInfo)
+	{
+		ConvertPositions(Mesh, Transform, MeshInfo.Vertices);
+		ConvertNormals(Mesh, Transform, MeshInfo.Normals);
+
+		//UV Coordinates - a single channel is duplicated into UV1
+		if (Mesh->GetNumUVChannels() > 1)
+		{
+			ConvertUVs(Mesh, 0, MeshInfo.UV0);
+			ConvertUVs(Mesh, 1, MeshInfo.UV1);
+		}
+		else if (Mesh->HasTextureCoords(0))
+		{
+			ConvertUVs(Mesh, 0, MeshInfo.UV0);
+			MeshInfo.UV1 = MeshInfo.UV0;
+		}
+		else
+		{
+			MeshInfo.UV0.Reset();
+			MeshInfo.UV1.Reset();
+		}
+
+		ConvertTangents(Mesh, Transform, MeshInfo.Tangents);
+	}
+
+	void ConvertPositions(const aiMesh * Mesh, const FMatrix& Transform, TArray<FVector>& OutPositions)
+	{
+		OutPositions.SetNumUninitialized(Mesh->mNumVertices, false);
+		if (IsIdentity(Transform))
+		{
+			FMemory::Memcpy(OutPositions.GetData(), Mesh->mVertices, Mesh->mNumVertices * sizeof(FVector));
+			return;
+		}
+		TransformPositions(Transform, reinterpret_cast<const FVector*>(Mesh->mVertices), OutPositions.GetData(), Mesh->mNumVertices);
+	}
+
+	void ConvertNormals(const aiMesh * Mesh, const FMatrix& Transform, TArray<FVector>& OutNormals)
+	{
+		if (!Mesh->HasNormals())
+		{
+			//TODO Generate Flat normals
+			UE_LOG(LogTemp, Warning, TEXT("NO NORMALS in mesh %s"), UTF8_TO_TCHAR(Mesh->mName.C_Str()));
+			OutNormals.Reset();
+			return;
+		}
+
+		OutNormals.SetNumUninitialized(Mesh->mNumVertices, false);
+		if (IsIdentity(Transform))
+		{
+			FMemory::Memcpy(OutNormals.GetData(), Mesh->mNormals, Mesh->mNumVertices * sizeof(FVector));
+			return;
+		}
+		TransformDirections(GetNormalMatrix(Transform), reinterpret_cast<const FVector*>(Mesh->mNormals), OutNormals.GetData(), Mesh->mNumVertices);
+	}
+
+	void ConvertUVs(const aiMesh * Mesh, uint32 Channel, TArray<FVector2D>& OutUVs)
+	{
+		const int32 NumVertices = Mesh->mNumVertices;
+		OutUVs.SetNumUninitialized(NumVertices, false);
+
+		const aiVector3D* RESTRICT Source = Mesh->mTextureCoords[Channel];
+		FVector2D* RESTRICT Dest = OutUVs.GetData();
+		for (int32 i = 0; i < NumVertices; ++i)
+		{
+			Dest[i].X = Source[i].x;
+			Dest[i].Y = -Source[i].y;
+		}
+	}
+
+	void ConvertTangents(const aiMesh * Mesh, const FMatrix& Transform, TArray<FProcMeshTangent>& OutTangents)
+	{
+		if (!Mesh->HasTangentsAndBitangents())
+		{
+			UE_LOG(LogTemp, Warning, TEXT("NO Tangents in mesh %s"), UTF8_TO_TCHAR(Mesh->mName.C_Str()));
+			OutTangents.Reset();
+			return;
+		}
+
+		const int32 NumVertices = Mesh->mNumVertices;
+		OutTangents.SetNumUninitialized(NumVertices, false);
+
+		const aiVector3D* RESTRICT Source = Mesh->mTangents;
+		FProcMeshTangent* RESTRICT Dest = OutTangents.GetData();
+		if (IsIdentity(Transform))
+		{
+			for (int32 i = 0; i < NumVertices; ++i)
+			{
+				Dest[i].TangentX = FVector(Source[i].x, Source[i].y, Source[i].z);
+				Dest[i].bFlipTangentY = false;
+			}
+			return;
+		}
+
+		// FProcMeshTangent is not tightly packed, so tangents go one per iteration
+		const FTransformRows Rows(Transform, false);
+		for (int32 i = 0; i < NumVertices; ++i)
+		{
+			const VectorRegister L = VectorLoadFloat3(&Source[i].x);
+			VectorStoreFloat3(NormalizeSafe3(Rows.Transform(VectorReplicate(L, 0), VectorReplicate(L, 1), VectorReplicate(L, 2))), &Dest[i].TangentX);
+			Dest[i].bFlipTangentY = false;
+		}
+	}
+}
+
+#if !UE_BUILD_SHIPPING
+
+// The conversion FindMeshInfo used before the stream kernels, kept as the benchmark baseline
+static void ConvertVerticesPerVertex(const aiMesh * Mesh, const FTransform& Transform, FMeshInfo& MeshInfo)
+{
+	for (uint32 j = 0; j < Mesh->mNumVertices; ++j)
+	{
+		FVector Vertex = FVector(Mesh->mVertices[j].x, Mesh->mVertices[j].y, Mesh->mVertices[j].z);
+		MeshInfo.Vertices.Push(Transform.TransformPosition(Vertex));
+
+		if (Mesh->HasNormals())
+		{
+			MeshInfo.Normals.Push(FVector(Mesh->mNormals[j].x, Mesh->mNormals[j].y, Mesh->mNormals[j].z));
+		}
+
+		if (Mesh->GetNumUVChannels() > 1)
+		{
+			MeshInfo.UV0.Add(FVector2D(Mesh->mTextureCoords[0][j].x, -Mesh->mTextureCoords[0][j].y));
+			MeshInfo.UV1.Add(FVector2D(Mesh->mTextureCoords[1][j].x, -Mesh->mTextureCoords[1][j].y));
+		}
+		else if (Mesh->HasTextureCoords(0))
+		{
+			FVector2D UV = FVector2D(Mesh->mTextureCoords[0][j].x, -Mesh->mTextureCoords[0][j].y);
+			MeshInfo.UV0.Add(UV);
+			MeshInfo.UV1.Add(UV);
+		}
+
+		if (Mesh->HasTangentsAndBitangents())
+		{
+			MeshInfo.Tangents.Push(FProcMeshTangent(Mesh->mTangents[j].x, Mesh->mTangents[j].y, Mesh->mTangents[j].z));
+		}
+	}
+}
+
+// Fills a synthetic mesh with every attribute FindMeshInfo reads
+static void FillBenchmarkMesh(aiMesh& Mesh, uint32 NumVertices)
+{
+	NumVertices -= NumVertices % 3;
+	FRandomStream Random(NumVertices);
+	Mesh.mNumVertices = NumVertices;
+	Mesh.mVertices = new aiVector3D[NumVertices];
+	Mesh.mNormals = new aiVector3D[NumVertices];
+	Mesh.mTangents = new aiVector3D[NumVertices];
+	Mesh.mBitangents = new aiVector3D[NumVertices];
+	Mesh.mTextureCoords[0] = new aiVector3D[NumVertices];
+	Mesh.mNumUVComponents[0] = 2;
+	for (uint32 i = 0; i < NumVertices; ++i)
+	{
+		Mesh.mVertices[i] = aiVector3D(Random.FRand(), Random.FRand(), Random.FRand());
+		Mesh.mNormals[i] = aiVector3D(0.f, 0.f, 1.f);
+		Mesh.mTangents[i] = aiVector3D(1.f, 0.f, 0.f);
+		Mesh.mBitangents[i] = aiVector3D(0.f, 1.f, 0.f);
+		Mesh.mTextureCoords[0][i] = aiVector3D(Random.FRand(), Random.FRand(), 0.f);
+	}
+
+	// Unindexed triangle soup
+	Mesh.mPrimitiveTypes = aiPrimitiveType_TRIANGLE;
+	Mesh.mNumFaces = NumVertices / 3;
+	Mesh.mFaces = new aiFace[Mesh.mNumFaces];
+	for (uint32 f = 0; f < Mesh.mNumFaces; ++f)
+	{
+		Mesh.mFaces[f].mNumIndices = 3;
+		Mesh.mFaces[f].mIndices = new unsigned int[3] { f * 3, f * 3 + 1, f * 3 + 2 };
+	}
+}
+
+// RuntimeMeshLoader.BenchmarkVertexConversion [NumVertices] [Iterations]
+static void BenchmarkVertexConversion(const TArray<FString>& Args)
+{
+	const uint32 NumVertices = Args.Num() > 0 ? FMath::Max(FCString::Atoi(*Args[0]), 3) : 2000000;
+	const int32 Iterations = Args.Num() > 1 ? FMath::Max(FCString::Atoi(*Args[1]), 1) : 5;
+
+	aiMesh Mesh;
+	FillBenchmarkMesh(Mesh, NumVertices);
+	const FTransform Transform(FRotator(0.f, -90.f, -90.f), FVector(0.f), FVector(100.f));
+	const FMatrix TransformMatrix = Transform.ToMatrixWithScale();
+
+	double PerVertexSeconds = 0.0;
+	double StreamSeconds = 0.0;
+	for (int32 Iteration = 0; Iteration < Iterations; ++Iteration)
+	{
+		{
+			FMeshInfo MeshInfo;
+			const double Start = FPlatformTime::Seconds();
+			ConvertVerticesPerVertex(&Mesh, Transform, MeshInfo);
+			PerVertexSeconds += FPlatformTime::Seconds() - Start;
+		}
+		{
+			FMeshInfo MeshInfo;
+			const double Start = FPlatformTime::Seconds();
+			GLTFMeshConversion::ConvertVertices(&Mesh, TransformMatrix, MeshInfo);
+			StreamSeconds += FPlatformTime::Seconds() - Start;
+		}
+	}
+
+	UE_LOG(LogTemp, Log, TEXT("Vertex conversion, %u vertices x %d: per vertex %.2f ms, streams %.2f ms (%.1fx)"),
+		NumVertices, Iterations,
+		PerVertexSeconds * 1000.0 / Iterations, StreamSeconds * 1000.0 / Iterations,
+		StreamSeconds > 0.0 ? PerVertexSeconds / StreamSeconds : 0.0);
+}
+
+static FAutoConsoleCommand BenchmarkVertexConversionCommand(
+	TEXT("RuntimeMeshLoader.BenchmarkVertexConversion"),
+	TEXT("Times per-vertex against per-stream vertex conversion. Args: [NumVertices] [Iterations]"),
+	FConsoleCommandWithArgsDelegate::CreateStatic(&BenchmarkVertexConversion));
+
+// RuntimeMeshLoader.BenchmarkVertexTransform [NumVertices] [Iterations]
+static void BenchmarkVertexTransform(const TArray<FString>& Args)
+{
+	const int32 NumVertices = Args.Num() > 0 ? FMath::Max(FCString::Atoi(*Args[0]), 1) : 2000000;
+	const int32 Iterations = Args.Num() > 1 ? FMath::Max(FCString::Atoi(*Args[1]), 1) : 5;
+
+	FRandomStream Random(NumVertices);
+	TArray<FVector> Source;
+	Source.SetNumUninitialized(NumVertices);
+	for (FVector& Vertex : Source)
+	{
+		Vertex = Random.GetUnitVector();
+	}
+	TArray<FVector> Dest;
+	Dest.SetNumUninitialized(NumVertices);
+
+	const FTransform Transform(FRotator(10.f, -90.f, -90.f), FVector(1.f, 2.f, 3.f), FVector(100.f));
+	const FMatrix TransformMatrix = Transform.ToMatrixWithScale();
+
+	double ScalarSeconds = 0.0;
+	double BatchSeconds = 0.0;
+	float MaxError = 0.0f;
+	for (int32 Iteration = 0; Iteration < Iterations; ++Iteration)
+	{
+		double Start = FPlatformTime::Seconds();
+		for (int32 i = 0; i < NumVertices; ++i)
+		{
+			Dest[i] = Transform.TransformPosition(Source[i]);
+		}
+		ScalarSeconds += FPlatformTime::Seconds() - Start;
+		const FVector Reference = Dest.Last();
+
+		Start = FPlatformTime::Seconds();
+		GLTFMeshConversion::TransformPositions(TransformMatrix, Source.GetData(), Dest.GetData(), NumVertices);
+		BatchSeconds += FPlatformTime::Seconds() - Start;
+		MaxError = FMath::Max(MaxError, (Reference - Dest.Last()).GetAbsMax());
+	}
+
+	UE_LOG(LogTemp, Log, TEXT("Position transform, %d vertices x %d: FTransform %.2f ms, batched matrix %.2f ms (%.1fx), max error %f"),
+		NumVertices, Iterations,
+		ScalarSeconds * 1000.0 / Iterations, BatchSeconds * 1000.0 / Iterations,
+		BatchSeconds > 0.0 ? ScalarSeconds / BatchSeconds : 0.0, MaxError);
+}
+
+static FAutoConsoleCommand BenchmarkVertexTransformCommand(
+	TEXT("RuntimeMeshLoader.BenchmarkVertexTransform"),
+	TEXT("Times FTransform::TransformPosition against the batched SIMD matrix kernel. Args: [NumVertices] [Iterations]"),
+	FConsoleCommandWithArgsDelegate::CreateStatic(&BenchmarkVertexTransform));
+
+// RuntimeMeshLoader.BenchmarkParallelConversion [NumMeshes] [VerticesPerMesh]
+static void BenchmarkParallelConversion(const TArray<FString>& Args)
+{
+	const int32 NumMeshes = Args.Num() > 0 ? FMath::Max(FCString::Atoi(*Args[0]), 1) : 2000;
+	const int32 VerticesPerMesh = Args.Num() > 1 ? FMath::Max(FCString::Atoi(*Args[1]), 3) : 3000;
+
+	// Mixed sizes like a real scene, a handful of big meshes and a long tail of small ones
+	TArray<aiMesh*> Meshes;
+	for (int32 i = 0; i < NumMeshes; ++i)
+	{
+		aiMesh* Mesh = new aiMesh();
+		FillBenchmarkMesh(*Mesh, (i % 50 == 0) ? VerticesPerMesh * 20 : VerticesPerMesh);
+		Meshes.Add(Mesh);
+	}
+	const FMatrix Transform = FTransform(FRotator(0.f, -90.f, -90.f), FVector(0.f), FVector(100.f)).ToMatrixWithScale();
+
+	const int32 MaxWorkers = FTaskGraphInterface::Get().GetNumWorkerThreads() + 1;
+	double SingleSeconds = 0.0;
+	for (int32 NumWorkers = 1; NumWorkers <= MaxWorkers; ++NumWorkers)
+	{
+		TArray<FMeshInfo> MeshInfo;
+		MeshInfo.SetNum(NumMeshes);
+		const double Start = FPlatformTime::Seconds();
+		GLTFMeshConversion::ParallelForMeshes(Meshes.GetData(), NumMeshes, [&](int32 i)
+		{
+			GLTFMeshConversion::ConvertVertices(Meshes[i], Transform, MeshInfo[i]);
+			GLTFMeshConversion::ConvertIndices(Meshes[i], MeshInfo[i].Triangles);
+		}, NumWorkers);
+		const double Seconds = FPlatformTime::Seconds() - Start;
+		if (NumWorkers == 1)
+		{
+			SingleSeconds = Seconds;
+		}
+
+		UE_LOG(LogTemp, Log, TEXT("Parallel conversion, %d meshes, %d workers: %.2f ms (%.2fx)"),
+			NumMeshes, NumWorkers, Seconds * 1000.0, Seconds > 0.0 ? SingleSeconds / Seconds : 0.0);
+	}
+
+	for (aiMesh* Mesh : Meshes)
+	{
+		delete Mesh;
+	}
+}
+
+static FAutoConsoleCommand BenchmarkParallelConversionCommand(
+	TEXT("RuntimeMeshLoader.BenchmarkParallelConversion"),
+	TEXT("Times mesh conversion of a synthetic scene with 1 to N workers. Args: [NumMeshes] [VerticesPerMesh]"),
+	FConsoleCommandWithArgsDelegate::CreateStatic(&BenchmarkParallelConversion));
+
+#endif
@@ -0,0 +1,64 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GLTFRuntimeAsset.h"
+#include "GLTFImportOptions.h"
+
+struct aiMesh;
+
+/*
+	Stream kernels turning Assimp meshes into FMeshInfo buffers.
+	Every output stream is sized once and filled by its own loop, attribute checks happen once per mesh.
+*/
+namespace GLTFMeshConversion
+{
+	// Overwrites the vertex streams of MeshInfo with the data of Mesh, baked with Transform.
+	// An identity Transform skips the transform pass, streams are copied as they are.
+	void ConvertVertices(const aiMesh * Mesh, const FMatrix& Transform, FMeshInfo& MeshInfo);
+
+	void ConvertPositions(const aiMesh * Mesh, const FMatrix& Transform, TArray<FVector>& OutPositions);
+
+	// Normals go through the inverse transpose of Transform and are renormalized
+	void ConvertNormals(const aiMesh * Mesh, const FMatrix& Transform, TArray<FVector>& OutNormals);
+
+	// glTF V runs downwards, so V is flipped on the way in
+	void ConvertUVs(const aiMesh * Mesh, uint32 Channel, TArray<FVector2D>& OutUVs);
+
+	// Tangents lie in the surface, so they go through Transform itself and are renormalized
+	void ConvertTangents(const aiMesh * Mesh, const FMatrix& Transform, TArray<FProcMeshTangent>& OutTangents);
+
+	// Flattens triangle faces into a triangle list. Point and line faces cannot be drawn as triangles and are skipped.
+	void ConvertIndices(const aiMesh * Mesh, TArray<int32>& OutIndices);
+
+	// Caller guarantees Mesh->mNumVertices <= 65536
+	void ConvertIndices(const aiMesh * Mesh, TArray<uint16>& OutIndices);
+
+	// Welds MeshInfo's vertices as described by FGLTFImportOptions::bWeldVertices. Works on the 32 bit Triangles,
+	// returns the number of vertices removed.
+	int32 WeldVertices(FMeshInfo& MeshInfo, const FGLTFImportOptions& Options);
+
+	// Up to MaxPoints vertices, the extremes along directions spread evenly over the sphere. Their convex hull is a close
+	// inner approximation of the mesh's hull and never needs more than MaxPoints vertices.
+	void ComputeHullPoints(const TArray<FVector>& Vertices, int32 MaxPoints, TArray<FVector>& OutPoints);
+
+	// Hash of the positions, indices and convex hull points of MeshInfo plus Salt
+	FSHAHash ComputeGeometryHash(const FMeshInfo& MeshInfo, uint8 Salt);
+
+	// Runs Body once per mesh index on the task graph. Meshes are handed out one at a time from a shared counter,
+	// largest first, so a few huge meshes do not end up queued behind each other. MaxWorkers <= 0 uses every worker.
+	void ParallelForMeshes(const aiMesh * const * Meshes, int32 NumMeshes, TFunctionRef<void(int32)> Body, int32 MaxWorkers = 0);
+
+	// Average cache miss ratio of Mesh's triangle order on a FIFO post-transform cache of CacheSize vertices
+	float ComputeACMR(const aiMesh * Mesh, int32 CacheSize);
+
+	// Triangle weighted ACMR over several meshes
+	float ComputeACMR(const aiMesh * const * Meshes, int32 NumMeshes, int32 CacheSize);
+
+	// SIMD kernels, four vertices per iteration. Source and Dest may alias.
+	void TransformPositions(const FMatrix& Transform, const FVector * Source, FVector * Dest, int32 Num);
+
+	void TransformDirections(const FMatrix& Transform, const FVector * Source, FVector * Dest, int32 Num);
+
+	// Matrix to use with TransformDirections for normals of a mesh transformed by Transform
+	FMatrix GetNormalMatrix(const FMatrix& Transform);
+}
@@ -0,0 +1,508 @@
+#include "GLTFMeshSimplifier.h"
+
+// Meshes smaller than this keep LOD 0 only
+static const int32 MinLODTriangles = 64;
+
+// Collapse passes before giving up on the target
+static const int32 MaxSimplifyIterations = 100;
+
+// Growth of the error threshold per pass, higher reduces faster and less carefully
+static const double SimplifyAggressiveness = 7.0;
+
+static FORCEINLINE double Det3(double A, double B, double C, double D, double E, double F, double G, double H, double I)
+{
+	return A * (E * I - F * H) - B * (D * I - F * G) + C * (D * H - E * G);
+}
+
+// Symmetric 4x4 error quadric, upper triangle only
+struct FQuadric
+{
+	double M[10];
+
+	FQuadric()
+	{
+		FMemory::Memzero(M);
+	}
+
+	// Squared distance to the plane AX + BY + CZ + D = 0
+	FQuadric(double A, double B, double C, double D)
+	{
+		M[0] = A * A; M[1] = A * B; M[2] = A * C; M[3] = A * D;
+		M[4] = B * B; M[5] = B * C; M[6] = B * D;
+		M[7] = C * C; M[8] = C * D;
+		M[9] = D * D;
+	}
+
+	FQuadric operator+(const FQuadric& Other) const
+	{
+		FQuadric Result;
+		for (int32 i = 0; i < 10; ++i)
+		{
+			Result.M[i] = M[i] + Other.M[i];
+		}
+		return Result;
+	}
+
+	double Evaluate(const FVector& P) const
+	{
+		const double X = P.X, Y = P.Y, Z = P.Z;
+		return M[0] * X * X + 2 * M[1] * X * Y + 2 * M[2] * X * Z + 2 * M[3] * X
+			+ M[4] * Y * Y + 2 * M[5] * Y * Z + 2 * M[6] * Y
+			+ M[7] * Z * Z + 2 * M[8] * Z
+			+ M[9];
+	}
+
+	// Position of minimal error, false when the quadric is degenerate (flat or straight neighbourhoods)
+	bool Minimize(FVector& OutPosition) const
+	{
+		const double Det = Det3(M[0], M[1], M[2], M[1], M[4], M[5], M[2], M[5], M[7]);
+		if (FMath::Abs(Det) < 1.0e-12) return false;
+
+		const double InvDet = -1.0 / Det;
+		OutPosition.X = InvDet * Det3(M[3], M[1], M[2], M[6], M[4], M[5], M[8], M[5], M[7]);
+		OutPosition.Y = InvDet * Det3(M[0], M[3], M[2], M[1], M[6], M[5], M[2], M[8], M[7]);
+		OutPosition.Z = InvDet * Det3(M[0], M[1], M[3], M[1], M[4], M[6], M[2], M[5], M[8]);
+		return true;
+	}
+};
+
+struct FSimplifyTriangle
+{
+	int32 V[3];
+	double Error[4]; // Per edge, and the smallest of them
+	FVector Normal;
+	bool bDeleted;
+	bool bDirty;
+};
+
+struct FSimplifyVertex
+{
+	FVector Position;
+	FQuadric Quadric;
+	int32 RefStart;
+	int32 RefCount;
+	bool bBorder;
+};
+
+// Triangle corner using a vertex
+struct FSimplifyRef
+{
+	int32 Triangle;
+	int32 Corner;
+};
+
+/*
+	Threshold driven variant of the collapse loop: every pass collapses all edges under a growing error threshold
+	instead of keeping a priority queue, which is much faster and close enough for LODs.
+	Works on positions normalized to the unit box so the thresholds do not depend on the mesh scale.
+*/
+class FQuadricSimplifier
+{
+public:
+	FQuadricSimplifier(const FMeshInfo& InSource)
+		: Source(InSource)
+		, NumDeleted(0)
+	{
+		const FBox Bounds(Source.Vertices);
+		Center = Bounds.GetCenter();
+		Scale = FMath::Max(Bounds.GetExtent().GetMax(), KINDA_SMALL_NUMBER);
+
+		Vertices.SetNumUninitialized(Source.Vertices.Num());
+		for (int32 i = 0; i < Vertices.Num(); ++i)
+		{
+			Vertices[i].Position = (Source.Vertices[i] - Center) / Scale;
+			Vertices[i].bBorder = false;
+		}
+
+		const TArray<int32>& Indices = Source.Triangles;
+		Triangles.Reserve(Indices.Num() / 3);
+		for (int32 t = 0; t + 2 < Indices.Num(); t += 3)
+		{
+			FSimplifyTriangle& Triangle = Triangles[Triangles.AddUninitialized()];
+			Triangle.V[0] = Indices[t];
+			Triangle.V[1] = Indices[t + 1];
+			Triangle.V[2] = Indices[t + 2];
+			Triangle.bDeleted = false;
+			Triangle.bDirty = false;
+		}
+
+		Normals = Source.Normals;
+		UV0 = Source.UV0;
+		UV1 = Source.UV1;
+		VertexColors = Source.VertexColors;
+		Tangents = Source.Tangents;
+	}
+
+	void Run(int32 TargetTriangles)
+	{
+		const int32 NumTriangles = Triangles.Num();
+		TArray<bool> Deleted0;
+		TArray<bool> Deleted1;
+
+		for (int32 Iteration = 0; Iteration < MaxSimplifyIterations; ++Iteration)
+		{
+			if (NumTriangles - NumDeleted <= TargetTriangles) break;
+
+			if (Iteration % 5 == 0)
+			{
+				UpdateMesh(Iteration);
+			}
+			for (FSimplifyTriangle& Triangle : Triangles)
+			{
+				Triangle.bDirty = false;
+			}
+
+			const double Threshold = 1.0e-9 * FMath::Pow(double(Iteration + 3), SimplifyAggressiveness);
+			for (int32 t = 0; t < Triangles.Num(); ++t)
+			{
+				// Read by index, collapsing appends to Refs but never moves Triangles
+				if (Triangles[t].Error[3] > Threshold || Triangles[t].bDeleted || Triangles[t].bDirty) continue;
+
+				for (int32 j = 0; j < 3; ++j)
+				{
+					if (Triangles[t].Error[j] > Threshold) continue;
+
+					const int32 I0 = Triangles[t].V[j];
+					const int32 I1 = Triangles[t].V[(j + 1) % 3];
+					if (Vertices[I0].bBorder || Vertices[I1].bBorder) continue;
+
+					FVector Position;
+					ComputeError(I0, I1, Position);
+
+					Deleted0.SetNumUninitialized(Vertices[I0].RefCount, false);
+					Deleted1.SetNumUninitialized(Vertices[I1].RefCount, false);
+					if (Flipped(Position, I0, I1, Deleted0)) continue;
+					if (Flipped(Position, I1, I0, Deleted1)) continue;
+
+					InterpolateAttributes(I0, I1, Position);
+					Vertices[I0].Position = Position;
+					Vertices[I0].Quadric = Vertices[I0].Quadric + Vertices[I1].Quadric;
+
+					const int32 RefStart = Refs.Num();
+					UpdateTriangles(I0, I0, Deleted0);
+					UpdateTriangles(I0, I1, Deleted1);
+					const int32 RefCount = Refs.Num() - RefStart;
+
+					FSimplifyVertex& Vertex0 = Vertices[I0];
+					if (RefCount <= Vertex0.RefCount)
+					{
+						// Reuse the old slot, saves memory
+						if (RefCount > 0)
+						{
+							FMemory::Memmove(&Refs[Vertex0.RefStart], &Refs[RefStart], RefCount * sizeof(FSimplifyRef));
+						}
+					}
+					else
+					{
+						Vertex0.RefStart = RefStart;
+					}
+					Vertex0.RefCount = RefCount;
+					break;
+				}
+
+				if (NumTriangles - NumDeleted <= TargetTriangles) break;
+			}
+		}
+	}
+
+	void Write(FMeshInfo& OutMesh) const
+	{
+		OutMesh.Name = Source.Name;
+		OutMesh.MaterialIndex = Source.MaterialIndex;
+		OutMesh.RelativeTransform = Source.RelativeTransform;
+
+		TArray<int32> NewIndex;
+		NewIndex.Init(INDEX_NONE, Vertices.Num());
+		OutMesh.Triangles.Reset(Triangles.Num() * 3);
+		OutMesh.Triangles16.Reset();
+		int32 NumUsed = 0;
+		for (const FSimplifyTriangle& Triangle : Triangles)
+		{
+			if (Triangle.bDeleted) continue;
+			for (int32 j = 0; j < 3; ++j)
+			{
+				int32& Index = NewIndex[Triangle.V[j]];
+				if (Index == INDEX_NONE)
+				{
+					Index = NumUsed++;
+				}
+				OutMesh.Triangles.Add(Index);
+			}
+		}
+
+		OutMesh.Vertices.SetNumUninitialized(NumUsed);
+		for (int32 i = 0; i < Vertices.Num(); ++i)
+		{
+			if (NewIndex[i] != INDEX_NONE)
+			{
+				OutMesh.Vertices[NewIndex[i]] = Vertices[i].Position * Scale + Center;
+			}
+		}
+		WriteStream(Normals, NewIndex, NumUsed, OutMesh.Normals);
+		WriteStream(UV0, NewIndex, NumUsed, OutMesh.UV0);
+		WriteStream(UV1, NewIndex, NumUsed, OutMesh.UV1);
+		WriteStream(VertexColors, NewIndex, NumUsed, OutMesh.VertexColors);
+		WriteStream(Tangents, NewIndex, NumUsed, OutMesh.Tangents);
+	}
+
+private:
+	template<typename ElementType>
+	void WriteStream(const TArray<ElementType>& Stream, const TArray<int32>& NewIndex, int32 NumUsed, TArray<ElementType>& OutStream) const
+	{
+		OutStream.Reset();
+		if (Stream.Num() != Vertices.Num()) return;
+		OutStream.SetNumUninitialized(NumUsed);
+		for (int32 i = 0; i < Stream.Num(); ++i)
+		{
+			if (NewIndex[i] != INDEX_NONE)
+			{
+				OutStream[NewIndex[i]] = Stream[i];
+			}
+		}
+	}
+
+	double ComputeError(int32 I0, int32 I1, FVector& OutPosition) const
+	{
+		const FQuadric Quadric = Vertices[I0].Quadric + Vertices[I1].Quadric;
+		if (Quadric.Minimize(OutPosition))
+		{
+			return Quadric.Evaluate(OutPosition);
+		}
+
+		// Degenerate, take the best of both ends and the midpoint
+		const FVector& P0 = Vertices[I0].Position;
+		const FVector& P1 = Vertices[I1].Position;
+		const FVector Mid = (P0 + P1) * 0.5f;
+		const double Error0 = Quadric.Evaluate(P0);
+		const double Error1 = Quadric.Evaluate(P1);
+		const double ErrorMid = Quadric.Evaluate(Mid);
+		const double Error = FMath::Min3(Error0, Error1, ErrorMid);
+		OutPosition = Error == Error0 ? P0 : (Error == Error1 ? P1 : Mid);
+		return Error;
+	}
+
+	// Whether moving I0 to Position flips or slivers one of its triangles. Marks the triangles shared with I1,
+	// which disappear with the collapse.
+	bool Flipped(const FVector& Position, int32 I0, int32 I1, TArray<bool>& OutDeleted) const
+	{
+		const FSimplifyVertex& Vertex = Vertices[I0];
+		for (int32 k = 0; k < Vertex.RefCount; ++k)
+		{
+			const FSimplifyRef& Ref = Refs[Vertex.RefStart + k];
+			const FSimplifyTriangle& Triangle = Triangles[Ref.Triangle];
+			if (Triangle.bDeleted) continue;
+
+			const int32 Id1 = Triangle.V[(Ref.Corner + 1) % 3];
+			const int32 Id2 = Triangle.V[(Ref.Corner + 2) % 3];
+			if (Id1 == I1 || Id2 == I1)
+			{
+				OutDeleted[k] = true;
+				continue;
+			}
+			OutDeleted[k] = false;
+
+			const FVector D1 = (Vertices[Id1].Position - Position).GetSafeNormal();
+			const FVector D2 = (Vertices[Id2].Position - Position).GetSafeNormal();
+			if (FMath::Abs(D1 | D2) > 0.999f) return true;
+
+			const FVector Normal = (D1 ^ D2).GetSafeNormal();
+			if ((Normal | Triangle.Normal) < 0.2f) return true;
+		}
+		return false;
+	}
+
+	// Points the triangles of Vertex at I0, drops the ones the collapse removed and appends their refs
+	void UpdateTriangles(int32 I0, int32 VertexIndex, const TArray<bool>& Deleted)
+	{
+		const FSimplifyVertex Vertex = Vertices[VertexIndex];
+		FVector Unused;
+		for (int32 k = 0; k < Vertex.RefCount; ++k)
+		{
+			const FSimplifyRef Ref = Refs[Vertex.RefStart + k];
+			FSimplifyTriangle& Triangle = Triangles[Ref.Triangle];
+			if (Triangle.bDeleted) continue;
+			if (Deleted[k])
+			{
+				Triangle.bDeleted = true;
+				++NumDeleted;
+				continue;
+			}
+			Triangle.V[Ref.Corner] = I0;
+			Triangle.bDirty = true;
+			Triangle.Error[0] = ComputeError(Triangle.V[0], Triangle.V[1], Unused);
+			Triangle.Error[1] = ComputeError(Triangle.V[1], Triangle.V[2], Unused);
+			Triangle.Error[2] = ComputeError(Triangle.V[2], Triangle.V[0], Unused);
+			Triangle.Error[3] = FMath::Min3(Triangle.Error[0], Triangle.Error[1], Triangle.Error[2]);
+			Refs.Add(Ref);
+		}
+	}
+
+	// The surviving vertex gets the attributes of the point on the edge closest to its new position
+	void InterpolateAttributes(int32 I0, int32 I1, const FVector& Position)
+	{
+		const FVector Edge = Vertices[I1].Position - Vertices[I0].Position;
+		const float EdgeLengthSquared = Edge.SizeSquared();
+		const float Alpha = EdgeLengthSquared > SMALL_NUMBER ? FMath::Clamp(((Position - Vertices[I0].Position) | Edge) / EdgeLengthSquared, 0.0f, 1.0f) : 0.0f;
+		if (Alpha <= 0.0f) return;
+
+		if (Normals.Num() == Vertices.Num()) Normals[I0] = FMath::Lerp(Normals[I0], Normals[I1], Alpha).GetSafeNormal();
+		if (UV0.Num() == Vertices.Num()) UV0[I0] = FMath::Lerp(UV0[I0], UV0[I1], Alpha);
+		if (UV1.Num() == Vertices.Num()) UV1[I0] = FMath::Lerp(UV1[I0], UV1[I1], Alpha);
+		if (VertexColors.Num() == Vertices.Num()) VertexColors[I0] = FMath::Lerp(VertexColors[I0], VertexColors[I1], Alpha);
+		if (Tangents.Num() == Vertices.Num()) Tangents[I0].TangentX = FMath::Lerp(Tangents[I0].TangentX, Tangents[I1].TangentX, Alpha).GetSafeNormal();
+	}
+
+	// Drops deleted triangles and rebuilds the vertex to triangle refs. The first call also sets up quadrics, edge errors and borders.
+	void UpdateMesh(int32 Iteration)
+	{
+		if (Iteration > 0)
+		{
+			Triangles.RemoveAll([](const FSimplifyTriangle& Triangle) { return Triangle.bDeleted; });
+		}
+
+		if (Iteration == 0)
+		{
+			for (FSimplifyVertex& Vertex : Vertices)
+			{
+				Vertex.Quadric = FQuadric();
+			}
+			for (FSimplifyTriangle& Triangle : Triangles)
+			{
+				const FVector& P0 = Vertices[Triangle.V[0]].Position;
+				Triangle.Normal = ((Vertices[Triangle.V[1]].Position - P0) ^ (Vertices[Triangle.V[2]].Position - P0)).GetSafeNormal();
+				const FQuadric Plane(Triangle.Normal.X, Triangle.Normal.Y, Triangle.Normal.Z, -(Triangle.Normal | P0));
+				for (int32 j = 0; j < 3; ++j)
+				{
+					Vertices[Triangle.V[j]].Quadric = Vertices[Triangle.V[j]].Quadric + Plane;
+				}
+			}
+			FVector Unused;
+			for (FSimplifyTriangle& Triangle : Triangles)
+			{
+				for (int32 j = 0; j < 3; ++j)
+				{
+					Triangle.Error[j] = ComputeError(Triangle.V[j], Triangle.V[(j + 1) % 3], Unused);
+				}
+				Triangle.Error[3] = FMath::Min3(Triangle.Error[0], Triangle.Error[1], Triangle.Error[2]);
+			}
+		}
+
+		for (FSimplifyVertex& Vertex : Vertices)
+		{
+			Vertex.RefStart = 0;
+			Vertex.RefCount = 0;
+		}
+		for (const FSimplifyTriangle& Triangle : Triangles)
+		{
+			for (int32 j = 0; j < 3; ++j)
+			{
+				++Vertices[Triangle.V[j]].RefCount;
+			}
+		}
+		int32 RefStart = 0;
+		for (FSimplifyVertex& Vertex : Vertices)
+		{
+			Vertex.RefStart = RefStart;
+			RefStart += Vertex.RefCount;
+			Vertex.RefCount = 0;
+		}
+		Refs.SetNumUninitialized(Triangles.Num() * 3, false);
+		for (int32 t = 0; t < Triangles.Num(); ++t)
+		{
+			for (int32 j = 0; j < 3; ++j)
+			{
+				FSimplifyVertex& Vertex = Vertices[Triangles[t].V[j]];
+				Refs[Vertex.RefStart + Vertex.RefCount++] = { t, j };
+			}
+		}
+
+		// A neighbour reached through a single triangle means an open edge
+		if (Iteration == 0)
+		{
+			TArray<int32, TInlineAllocator<32>> Neighbours;
+			TArray<int32, TInlineAllocator<32>> NeighbourCounts;
+			for (const FSimplifyVertex& Vertex : Vertices)
+			{
+				Neighbours.Reset();
+				NeighbourCounts.Reset();
+				for (int32 k = 0; k < Vertex.RefCount; ++k)
+				{
+					const FSimplifyTriangle& Triangle = Triangles[Refs[Vertex.RefStart + k].Triangle];
+					for (int32 j = 0; j < 3; ++j)
+					{
+						const int32 Found = Neighbours.Find(Triangle.V[j]);
+						if (Found == INDEX_NONE)
+						{
+							Neighbours.Add(Triangle.V[j]);
+							NeighbourCounts.Add(1);
+						}
+						else
+						{
+							++NeighbourCounts[Found];
+						}
+					}
+				}
+				for (int32 n = 0; n < Neighbours.Num(); ++n)
+				{
+					if (NeighbourCounts[n] == 1)
+					{
+						Vertices[Neighbours[n]].bBorder = true;
+					}
+				}
+			}
+		}
+	}
+
+	const FMeshInfo& Source;
+	FVector Center;
+	float Scale;
+
+	TArray<FSimplifyVertex> Vertices;
+	TArray<FSimplifyTriangle> Triangles;
+	TArray<FSimplifyRef> Refs;
+	int32 NumDeleted; // Since the start, compacting Triangles does not reset it
+
+	// Working copies, collapses interpolate into them
+	TArray<FVector> Normals;
+	TArray<FVector2D> UV0;
+	TArray<FVector2D> UV1;
+	TArray<FLinearColor> VertexColors;
+	TArray<FProcMeshTangent> Tangents;
+};
+
+namespace GLTFMeshSimplifier
+{
+	void Simplify(const FMeshInfo& Source, int32 TargetTriangles, FMeshInfo& OutMesh)
+	{
+		FQuadricSimplifier Simplifier(Source);
+		Simplifier.Run(TargetTriangles);
+		Simplifier.Write(OutMesh);
+	}
+
+	void BuildLODChain(const FMeshInfo& MeshInfo, const FGLTFImportOptions& Options, TArray<FMeshLOD>& OutLODs)
+	{
+		OutLODs.Reset();
+		const int32 NumTriangles = MeshInfo.Triangles.Num() / 3;
+		if (NumTriangles < MinLODTriangles) return;
+
+		// Previous points into OutLODs, which must not reallocate
+		OutLODs.Reserve(Options.LODTriangleRatios.Num());
+		const FMeshInfo* Previous = &MeshInfo;
+		for (int32 i = 0; i < Options.LODTriangleRatios.Num(); ++i)
+		{
+			const int32 TargetTriangles = FMath::Max(FMath::RoundToInt(NumTriangles * Options.LODTriangleRatios[i]), 1);
+			const int32 PreviousTriangles = Previous->Triangles.Num() / 3;
+			if (TargetTriangles >= PreviousTriangles) continue;
+
+			FMeshLOD& LOD = OutLODs[OutLODs.AddDefaulted()];
+			LOD.ScreenSize = Options.LODScreenSizes.IsValidIndex(i) ? Options.LODScreenSizes[i] : Options.LODTriangleRatios[i];
+			Simplify(*Previous, TargetTriangles, LOD.Mesh);
+			if (LOD.Mesh.Triangles.Num() / 3 >= PreviousTriangles)
+			{
+				OutLODs.Pop(false);
+				break;
+			}
+			Previous = &LOD.Mesh;
+		}
+	}
+}
@@ -0,0 +1,19 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GLTFRuntimeAsset.h"
+#include "GLTFImportOptions.h"
+
+/*
+	Quadric error edge collapse (Garland & Heckbert) used to build LOD chains on the import workers.
+*/
+namespace GLTFMeshSimplifier
+{
+	// Collapses edges of Source until about TargetTriangles are left. Vertices on open borders and attribute seams stay put,
+	// so meshes that were not welded barely reduce. Reads the 32 bit Triangles of Source.
+	void Simplify(const FMeshInfo& Source, int32 TargetTriangles, FMeshInfo& OutMesh);
+
+	// Fills OutLODs following FGLTFImportOptions::LODTriangleRatios, every LOD is reduced from the one before it.
+	// Stops early once a step no longer removes triangles.
+	void BuildLODChain(const FMeshInfo& MeshInfo, const FGLTFImportOptions& Options, TArray<FMeshLOD>& OutLODs);
+}
@@ -0,0 +1,127 @@
+#include "GLTFProcMeshBuilder.h"
+#include "ProceduralMeshComponent.h"
+
+// Interleaves the vertex streams of MeshInfo into Section, with the same defaults as CreateMeshSection
+static void FillVertices(FProcMeshSection& Section, const FMeshInfo& MeshInfo)
+{
+	const int32 NumVertices = MeshInfo.Vertices.Num();
+	Section.SectionLocalBox.Init();
+	Section.ProcVertexBuffer.SetNumUninitialized(NumVertices);
+	for (int32 i = 0; i < NumVertices; ++i)
+	{
+		FProcMeshVertex& Vertex = Section.ProcVertexBuffer[i];
+		Vertex.Position = MeshInfo.Vertices[i];
+		Vertex.Normal = MeshInfo.Normals.IsValidIndex(i) ? MeshInfo.Normals[i] : FVector(0.0f, 0.0f, 1.0f);
+		Vertex.Tangent = MeshInfo.Tangents.IsValidIndex(i) ? MeshInfo.Tangents[i] : FProcMeshTangent();
+		Vertex.Color = MeshInfo.VertexColors.IsValidIndex(i) ? MeshInfo.VertexColors[i].ToFColor(false) : FColor(255, 255, 255);
+		Vertex.UV0 = MeshInfo.UV0.IsValidIndex(i) ? MeshInfo.UV0[i] : FVector2D::ZeroVector;
+		Section.SectionLocalBox += Vertex.Position;
+	}
+}
+
+// Same clamping as CreateMeshSection, a partial triangle at the end is dropped
+static void FillIndices(FProcMeshSection& Section, const FMeshInfo& MeshInfo)
+{
+	const int32 NumIndices = (MeshInfo.GetNumIndices() / 3) * 3;
+	const int32 MaxIndex = FMath::Max(Section.ProcVertexBuffer.Num() - 1, 0);
+	Section.ProcIndexBuffer.SetNumUninitialized(NumIndices);
+	for (int32 i = 0; i < NumIndices; ++i)
+	{
+		const int32 Index = MeshInfo.Triangles16.Num() > 0 ? MeshInfo.Triangles16[i] : MeshInfo.Triangles[i];
+		Section.ProcIndexBuffer[i] = FMath::Min(Index, MaxIndex);
+	}
+}
+
+static void FillSection(FProcMeshSection& Section, const FMeshInfo& MeshInfo)
+{
+	FillVertices(Section, MeshInfo);
+	FillIndices(Section, MeshInfo);
+}
+
+// Frees every stream of MeshInfo as soon as it is converted
+static void FillSection(FProcMeshSection& Section, FMeshInfo&& MeshInfo)
+{
+	FillVertices(Section, MeshInfo);
+	MeshInfo.Vertices.Empty();
+	MeshInfo.Normals.Empty();
+	MeshInfo.Tangents.Empty();
+	MeshInfo.VertexColors.Empty();
+	MeshInfo.UV0.Empty();
+	MeshInfo.UV1.Empty();
+
+	FillIndices(Section, MeshInfo);
+	MeshInfo.Triangles.Empty();
+	MeshInfo.Triangles16.Empty();
+}
+
+// Adds section SectionIndex empty, with the bounds of MeshInfo, and returns it for the geometry to be written into
+static FProcMeshSection* AddEmptySection(UProceduralMeshComponent* Component, int32 SectionIndex, const FMeshInfo& MeshInfo)
+{
+	check(IsInGameThread());
+
+	FProcMeshSection Placeholder;
+	Placeholder.SectionLocalBox = FBox(MeshInfo.Vertices);
+	Component->SetProcMeshSection(SectionIndex, Placeholder);
+	return Component->GetProcMeshSection(SectionIndex);
+}
+
+namespace GLTFProcMeshBuilder
+{
+	FProcMeshSection BuildSection(const FMeshInfo& MeshInfo, bool bCreateCollision)
+	{
+		FProcMeshSection Section;
+		Section.bEnableCollision = bCreateCollision;
+		FillSection(Section, MeshInfo);
+		return Section;
+	}
+
+	FProcMeshSection BuildSection(FMeshInfo&& MeshInfo, bool bCreateCollision)
+	{
+		FProcMeshSection Section;
+		Section.bEnableCollision = bCreateCollision;
+		FillSection(Section, MoveTemp(MeshInfo));
+		return Section;
+	}
+
+	void CreateMeshSection(UProceduralMeshComponent* Component, int32 SectionIndex, const FMeshInfo& MeshInfo, bool bCreateCollision)
+	{
+		// Collision is cooked from the section data inside SetProcMeshSection, so those sections have to go in complete
+		if (bCreateCollision)
+		{
+			Component->SetProcMeshSection(SectionIndex, BuildSection(MeshInfo, true));
+			return;
+		}
+		FillSection(*AddEmptySection(Component, SectionIndex, MeshInfo), MeshInfo);
+		// SetProcMeshSection only saw the empty section
+		Component->MarkRenderStateDirty();
+	}
+
+	void CreateMeshSection(UProceduralMeshComponent* Component, int32 SectionIndex, FMeshInfo&& MeshInfo, bool bCreateCollision)
+	{
+		if (bCreateCollision)
+		{
+			Component->SetProcMeshSection(SectionIndex, BuildSection(MoveTemp(MeshInfo), true));
+			return;
+		}
+		FillSection(*AddEmptySection(Component, SectionIndex, MeshInfo), MoveTemp(MeshInfo));
+		Component->MarkRenderStateDirty();
+	}
+
+	void UpdateMeshSection(UProceduralMeshComponent* Component, int32 SectionIndex, const FMeshInfo& MeshInfo)
+	{
+		check(IsInGameThread());
+
+		FProcMeshSection* Section = Component->GetProcMeshSection(SectionIndex);
+		if (!Section)
+		{
+			CreateMeshSection(Component, SectionIndex, MeshInfo, false);
+			return;
+		}
+
+		// The component bounds were computed from this box, keep it so they still cover the section
+		const FBox SectionLocalBox = Section->SectionLocalBox;
+		FillSection(*Section, MeshInfo);
+		Section->SectionLocalBox = SectionLocalBox;
+		Component->MarkRenderStateDirty();
+	}
+}
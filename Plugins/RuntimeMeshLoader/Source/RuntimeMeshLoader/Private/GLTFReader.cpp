@@ -139,6 +139,10 @@ void GLTFReader::SetupImage(const FJsonObject& Object)
 		{
 			ImageInfo.ImageFormat = FImageInfo::EExtension::JPEG;
 		}
+		else if (ImageInfo.URI.EndsWith(".ktx2") || GetString(Object, "mimeType").Equals("image/ktx2"))
+		{
+			ImageInfo.ImageFormat = FImageInfo::EExtension::KTX2;
+		}
 		else
 		{
 			UE_LOG(LogTemp, Error, TEXT("Unknown file format, could not be read."));
@@ -154,6 +158,21 @@ void GLTFReader::SetupTexture(const FJsonObject& Object)
 		ITextureInfo.Name = GetString(Object, "name");
     if (Object.HasTypedField<EJson::Number>("source"))
 		ITextureInfo.Source = GetInt(Object, "source");
+
+	// KHR_texture_basisu points at a KTX2 image, "source" is then only there for importers without the extension
+	if (Object.HasTypedField<EJson::Object>("extensions"))
+	{
+		const FJsonObject& Extensions = *Object.GetObjectField("extensions");
+		if (Extensions.HasTypedField<EJson::Object>("KHR_texture_basisu"))
+		{
+			const FJsonObject& BasisU = *Extensions.GetObjectField("KHR_texture_basisu");
+			if (BasisU.HasTypedField<EJson::Number>("source"))
+			{
+				ITextureInfo.FallbackSource = ITextureInfo.Source;
+				ITextureInfo.Source = GetInt(BasisU, "source");
+			}
+		}
+	}
 }
 
 void GLTFReader::SetupMaterial(const FJsonObject& Object)
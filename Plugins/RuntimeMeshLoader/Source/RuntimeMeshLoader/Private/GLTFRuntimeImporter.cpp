@@ -2,6 +2,10 @@
 #include "GLTFRuntimeImporter.h"
 #include "RuntimeMeshLoader.h"
 #include "GLTFRuntimeMaterial.h"
+#include "GLTFMeshConversion.h"
+#include "GLTFMeshSimplifier.h"
+#include "HAL/ThreadSafeCounter64.h"
+#include "Async/ParallelFor.h"
 
 #if PLATFORM_ANDROID
 #include "Android/AndroidJNI.h"
@@ -16,10 +20,127 @@ static jmethodID GetExternalDirMethodId;
 #include "assimp/Importer.hpp"  // C++ importer interface
 #include "assimp/scene.h"       // Output data structure
 #include "assimp/postprocess.h" // Post processing flags
+#include "assimp/ProgressHandler.hpp"
+#include "assimp/config.h"
+#include "assimp/material.h"
 //#endif
 
 FAssimpImport* FAssimpImport::Instance = nullptr;
 
+// How long an idle worker sleeps before re-checking the queue and its own stop flag
+static const uint32 AssimpWorkerIdleWaitMs = 100;
+
+// Minimum time between two progress broadcasts of the same job
+static const double ImportProgressIntervalSeconds = 0.05;
+
+// Share of the overall progress bar each phase takes, indexed by EAssimpImportPhase
+static const float ImportPhaseWeights[(int32)EAssimpImportPhase::Done] = { 0.35f, 0.15f, 0.35f, 0.15f };
+
+/*
+	Forwards Assimp's read and post-process callbacks to the job as progress. It cannot abort anything: this Assimp
+	version ignores what Update returns, so a cancel is only seen at the IsCancelled checks after ReadFile and
+	ApplyPostProcessing. The Assimp::Importer owns and deletes it.
+*/
+class FAssimpProgressHandler : public Assimp::ProgressHandler
+{
+public:
+
+	explicit FAssimpProgressHandler(FAssimpImportJob& InJob) : Job(InJob) {}
+
+	virtual bool Update(float Percentage) override
+	{
+		return true;
+	}
+
+	virtual void UpdateFileRead(int CurrentStep, int NumberOfSteps) override
+	{
+		Job.ReportProgress(EAssimpImportPhase::Read, NumberOfSteps ? (float)CurrentStep / NumberOfSteps : 1.0f);
+	}
+
+	virtual void UpdatePostProcess(int CurrentStep, int NumberOfSteps) override
+	{
+		Job.ReportProgress(EAssimpImportPhase::PostProcess, NumberOfSteps ? (float)CurrentStep / NumberOfSteps : 1.0f);
+	}
+
+private:
+
+	FAssimpImportJob& Job;
+};
+
+static uint32 GetPostProcessFlags(const FGLTFImportOptions& Options)
+{
+	uint32 Flags = aiProcess_Triangulate | aiProcess_MakeLeftHanded;
+	switch (Options.Preset)
+	{
+	case EGLTFImportPreset::Fast:
+		// Flat normals are cheaper and only generated when missing anyway
+		Flags |= aiProcess_GenNormals | aiProcess_RemoveComponent;
+		break;
+	case EGLTFImportPreset::Quality:
+		Flags |= aiProcess_JoinIdenticalVertices | aiProcess_ImproveCacheLocality | aiProcess_FindInstances
+			| aiProcess_FindDegenerates | aiProcess_FindInvalidData | aiProcess_SortByPType | aiProcess_RemoveRedundantMaterials;
+		// fall through
+	case EGLTFImportPreset::Balanced:
+	default:
+		Flags |= aiProcess_GenSmoothNormals | aiProcess_GenUVCoords | aiProcess_CalcTangentSpace | aiProcess_OptimizeMeshes;
+		break;
+	}
+	if (Options.bOptimizeForRendering)
+	{
+		Flags |= aiProcess_SplitLargeMeshes | aiProcess_ImproveCacheLocality;
+	}
+	Flags |= Options.ExtraPostProcessFlags;
+	Flags &= ~Options.DisabledPostProcessFlags;
+	// Everything downstream assumes Unreal's handedness
+	return Flags | aiProcess_MakeLeftHanded;
+}
+
+static void SetImporterProperties(Assimp::Importer& Importer, const FGLTFImportOptions& Options)
+{
+	Importer.SetPropertyFloat(AI_CONFIG_PP_GSN_MAX_SMOOTHING_ANGLE, Options.NormalSmoothingAngle);
+	Importer.SetPropertyFloat(AI_CONFIG_PP_CT_MAX_SMOOTHING_ANGLE, Options.TangentSmoothingAngle);
+	// Nothing downstream reads these, dropping them early saves memory and post-process time
+	Importer.SetPropertyInteger(AI_CONFIG_PP_RVC_FLAGS, aiComponent_COLORS | aiComponent_BONEWEIGHTS | aiComponent_ANIMATIONS | aiComponent_LIGHTS | aiComponent_CAMERAS);
+	// Points and lines cannot be drawn as sections
+	Importer.SetPropertyInteger(AI_CONFIG_PP_SBP_REMOVE, aiPrimitiveType_POINT | aiPrimitiveType_LINE);
+	Importer.SetPropertyInteger(AI_CONFIG_PP_SLM_VERTEX_LIMIT, FMath::Max(Options.MaxSectionVertices, 3));
+	Importer.SetPropertyInteger(AI_CONFIG_PP_SLM_TRIANGLE_LIMIT, FMath::Max(Options.MaxSectionTriangles, 1));
+	Importer.SetPropertyInteger(AI_CONFIG_PP_ICL_PTCACHE_SIZE, FMath::Max(Options.VertexCacheSize, 3));
+}
+
+// Drops steps whose result the freshly read scene already has
+static uint32 SkipRedundantSteps(const aiScene* Scene, uint32 Flags)
+{
+	bool bAllNormals = true;
+	bool bAllTangents = true;
+	bool bAllTriangles = true;
+	bool bAllUVs = true;
+	bool bAnyUVs = false;
+	for (uint32 i = 0; i < Scene->mNumMeshes; ++i)
+	{
+		const aiMesh* Mesh = Scene->mMeshes[i];
+		bAllNormals &= Mesh->HasNormals();
+		bAllTangents &= Mesh->HasTangentsAndBitangents();
+		bAllTriangles &= Mesh->mPrimitiveTypes == aiPrimitiveType_TRIANGLE;
+		bAllUVs &= Mesh->HasTextureCoords(0);
+		bAnyUVs |= Mesh->HasTextureCoords(0);
+	}
+
+	bool bAnyNormalMaps = false;
+	for (uint32 i = 0; i < Scene->mNumMaterials && !bAnyNormalMaps; ++i)
+	{
+		bAnyNormalMaps = Scene->mMaterials[i]->GetTextureCount(aiTextureType_NORMALS) > 0
+			|| Scene->mMaterials[i]->GetTextureCount(aiTextureType_HEIGHT) > 0;
+	}
+
+	if (bAllNormals) Flags &= ~(aiProcess_GenSmoothNormals | aiProcess_GenNormals);
+	// Tangents only feed normal mapping and need UVs to be computed at all
+	if (bAllTangents || !bAnyNormalMaps || !bAnyUVs) Flags &= ~aiProcess_CalcTangentSpace;
+	if (bAllTriangles) Flags &= ~(aiProcess_Triangulate | aiProcess_SortByPType);
+	if (bAllUVs) Flags &= ~aiProcess_GenUVCoords;
+	return Flags;
+}
+
 static TArray<FVector> GenerateFlatNormals(const TArray<FVector>& Positions, const TArray<uint32>& Indices)
 {
     TArray<FVector> Normals;
@@ -44,180 +165,901 @@ static TArray<FVector> GenerateFlatNormals(const TArray<FVector>& Positions, con
     return Normals;
 }
 
+// glTF Y-up meters to Unreal Z-up centimeters
+static const FTransform& GetBasisTransform()
+{
+	static const FTransform Basis(FRotator(0.f, -90.f, -90.f), FVector(0.f), FVector(100.f));
+	return Basis;
+}
+
+// A node referencing a mesh, collected by the node traversal before the parallel conversion
+struct FMeshNodeReference
+{
+	FMatrix NodeTransform; //Accumulated from the root, glTF space
+	FString NodeName;
+	int32 NodeIndex;
+};
+
+static FMatrix ToMatrix(const aiMatrix4x4& TransformMatrix)
+{
+	FMatrix Matrix;
+	Matrix.M[0][0] = TransformMatrix.a1; Matrix.M[0][1] = TransformMatrix.b1; Matrix.M[0][2] = TransformMatrix.c1; Matrix.M[0][3] = TransformMatrix.d1;
+	Matrix.M[1][0] = TransformMatrix.a2; Matrix.M[1][1] = TransformMatrix.b2; Matrix.M[1][2] = TransformMatrix.c2; Matrix.M[1][3] = TransformMatrix.d2;
+	Matrix.M[2][0] = TransformMatrix.a3; Matrix.M[2][1] = TransformMatrix.b3; Matrix.M[2][2] = TransformMatrix.c3; Matrix.M[2][3] = TransformMatrix.d3;
+	Matrix.M[3][0] = TransformMatrix.a4; Matrix.M[3][1] = TransformMatrix.b4; Matrix.M[3][2] = TransformMatrix.c4; Matrix.M[3][3] = TransformMatrix.d4;
+	return Matrix;
+}
+
+// glTF space matrix expressed in the Unreal basis, so it can be applied to converted vertex data
+static FMatrix ToBasisSpace(const FMatrix& Matrix)
+{
+	static const FMatrix Basis = GetBasisTransform().ToMatrixWithScale();
+	static const FMatrix InverseBasis = Basis.Inverse();
+	return InverseBasis * Matrix * Basis;
+}
+
 //#if PLATFORM_ANDROID || PLATFORM_IOS
-void FindMeshInfo(const aiScene* Scene, aiNode* Node, FGLTFRuntimeAsset * Result)
+void FindMeshInfo(const aiScene* Scene, const aiNode* Node, int32 NodeIndex, const FMatrix& WorldMatrix, TArray<TArray<FMeshNodeReference>>& OutReferences)
 {
-	if (!Result) return;
 	for (uint32 i = 0; i < Node->mNumMeshes; i++)
 	{
-		int32 MeshIndex = *Node->mMeshes;
-		aiMesh *Mesh = Scene->mMeshes[MeshIndex];
-		FMeshInfo &MeshInfo = Result->MeshInfo[MeshIndex];
-
-		//transform.
-		aiMatrix4x4 TransformMatrix = Node->mTransformation;
-        //Node-
-		FMatrix Matrix;
-        Matrix.M[0][0] = TransformMatrix.a1; Matrix.M[0][1] = TransformMatrix.b1; Matrix.M[0][2] = TransformMatrix.c1; Matrix.M[0][3] = TransformMatrix.d1;
-		Matrix.M[1][0] = TransformMatrix.a2; Matrix.M[1][1] = TransformMatrix.b2; Matrix.M[1][2] = TransformMatrix.c2; Matrix.M[1][3] = TransformMatrix.d2;
-		Matrix.M[2][0] = TransformMatrix.a3; Matrix.M[2][1] = TransformMatrix.b3; Matrix.M[2][2] = TransformMatrix.c3; Matrix.M[2][3] = TransformMatrix.d3;
-		Matrix.M[3][0] = TransformMatrix.a4; Matrix.M[3][1] = TransformMatrix.b4; Matrix.M[3][2] = TransformMatrix.c4; Matrix.M[3][3] = TransformMatrix.d4;
-		
-		//UE_LOG(LogTemp, Warning, TEXT("Name node : %s"), *MeshInfo.Name);
-		//	Matrix.M[0][0], Matrix.M[0][1], Matrix.M[0][2], Matrix.M[0][3],
-		//	Matrix.M[1][0], Matrix.M[1][1], Matrix.M[1][2], Matrix.M[1][3],
-		//	Matrix.M[2][0], Matrix.M[2][1], Matrix.M[2][2], Matrix.M[2][3],
-		//	Matrix.M[3][0], Matrix.M[3][1], Matrix.M[3][2], Matrix.M[3][3]);
-
-		MeshInfo.RelativeTransform = FTransform(Matrix);
-        MeshInfo.RelativeTransform *= FTransform(FRotator(0.f, -90.f, -90.f), FVector(0.f), FVector(100.f));
-        TArray<FVector> Vertices;
-        TArray<uint32> indexes;
-        int32 counter = 0;
-		//vet
-		for (uint32 j = 0; j < Mesh->mNumVertices; ++j)
-		{
-			FVector Vertex = FVector(
-				Mesh->mVertices[j].x,
-                Mesh->mVertices[j].y,
-				Mesh->mVertices[j].z);
-                Vertex = MeshInfo.RelativeTransform.TransformPosition(Vertex);
-			    MeshInfo.Vertices.Push(Vertex);
-            
-            Vertices.Add(Vertex);
-            ++counter;
-            
-			//Normal
-            if (Mesh->HasNormals())
-            {
-                FVector Normal = FVector(
-                    Mesh->mNormals[j].x,
-                    Mesh->mNormals[j].y,
-                    Mesh->mNormals[j].z);
-                MeshInfo.Normals.Push(Normal);
-            }
-            else
-            {
-                //TODO Generate Flat normals
-                UE_LOG(LogTemp, Warning, TEXT("NO NORMALS"));
-            }
-			//UV Coordinates - inconsistent coordinates
-            int32 numUVChannels  = Mesh->GetNumUVChannels();
-            if(numUVChannels > 1)
-            {
-                FVector2D UV0 = FVector2D(Mesh->mTextureCoords[0][j].x, -Mesh->mTextureCoords[0][j].y);
-                MeshInfo.UV0.Add(UV0);
-                FVector2D UV1 = FVector2D(Mesh->mTextureCoords[1][j].x, -Mesh->mTextureCoords[1][j].y);
-                MeshInfo.UV1.Add(UV1);
-            }
-            else
-            {
-                if (Mesh->HasTextureCoords(0))
-                {
-                    FVector2D UV = FVector2D(Mesh->mTextureCoords[0][j].x, -Mesh->mTextureCoords[0][j].y);
-                    MeshInfo.UV0.Add(UV);
-                    MeshInfo.UV1.Add(UV);
-                }
-            }
-            
-			//Tangent
-            if (Mesh->HasTangentsAndBitangents())
-            {
-                FProcMeshTangent MeshTangent = FProcMeshTangent(
-                    Mesh->mTangents[j].x,
-                    Mesh->mTangents[j].y,
-                    Mesh->mTangents[j].z
-                );
-                MeshInfo.Tangents.Push(MeshTangent);
-            }else
-            {
-                UE_LOG(LogTemp, Warning, TEXT("NO Tangents"));
-            }
-		}
+		const uint32 MeshIndex = Node->mMeshes[i];
+		if (MeshIndex >= Scene->mNumMeshes) continue;
+
+		FMeshNodeReference& Reference = OutReferences[MeshIndex][OutReferences[MeshIndex].AddDefaulted()];
+		Reference.NodeTransform = WorldMatrix;
+		Reference.NodeName = FString(UTF8_TO_TCHAR(Node->mName.C_Str()));
+		Reference.NodeIndex = NodeIndex;
 	}
 }
 //#endif
 //#if PLATFORM_ANDROID || PLATFORM_IOS
-void FindMesh(const aiScene* Scene, aiNode* Node, FGLTFRuntimeAsset * OutData)
+/*
+	Walks the node tree depth first with an explicit stack, deep hierarchies cannot overflow the worker's stack.
+	World matrices are accumulated on the way down. Nodes are stored parents first, in the same order as a recursive walk.
+*/
+void FindMesh(const aiScene* Scene, FGLTFRuntimeAsset * OutData, TArray<TArray<FMeshNodeReference>>& OutReferences, FAssimpImportJob& Job)
 {
-	FindMeshInfo(Scene, Node, OutData);
+	struct FPendingNode
+	{
+		const aiNode* Node;
+		int32 ParentIndex;
+	};
+
+	TArray<FPendingNode> Stack;
+	TArray<FMatrix> WorldMatrices;
+	Stack.Add({ Scene->mRootNode, INDEX_NONE });
 
-	for (uint32 i = 0; i < Node->mNumChildren; ++i)
+	while (Stack.Num() > 0)
 	{
-		FindMesh(Scene, Node->mChildren[i], OutData);
+		if (Job.IsCancelled()) return;
+
+		const FPendingNode Pending = Stack.Pop(false);
+		const aiNode* Node = Pending.Node;
+
+		const FMatrix LocalMatrix = ToMatrix(Node->mTransformation);
+		const FMatrix WorldMatrix = Pending.ParentIndex == INDEX_NONE ? LocalMatrix : LocalMatrix * WorldMatrices[Pending.ParentIndex];
+
+		const int32 NodeIndex = OutData->Nodes.AddDefaulted();
+		WorldMatrices.Add(WorldMatrix);
+		FGLTFNode& NodeInfo = OutData->Nodes[NodeIndex];
+		NodeInfo.Name = FString(UTF8_TO_TCHAR(Node->mName.C_Str()));
+		NodeInfo.ParentIndex = Pending.ParentIndex;
+		NodeInfo.LocalTransform = FTransform(ToBasisSpace(LocalMatrix));
+		NodeInfo.WorldTransform = FTransform(ToBasisSpace(WorldMatrix));
+		for (uint32 i = 0; i < Node->mNumMeshes; ++i)
+		{
+			NodeInfo.MeshIndices.Add(Node->mMeshes[i]);
+		}
+		if (Pending.ParentIndex != INDEX_NONE)
+		{
+			OutData->Nodes[Pending.ParentIndex].Children.Add(NodeIndex);
+		}
+
+		FindMeshInfo(Scene, Node, NodeIndex, WorldMatrix, OutReferences);
+
+		// Reversed, so the first child is popped first
+		for (int32 i = (int32)Node->mNumChildren - 1; i >= 0; --i)
+		{
+			Stack.Add({ Node->mChildren[i], NodeIndex });
+		}
 	}
 }
 //#endif
+
+/*
+	Decides the space every mesh is converted into and emits its instance records.
+	When baking, a mesh used by a single node gets that node baked into its vertices and an identity instance,
+	a shared mesh is converted once in basis space and each node becomes an instance transform.
+	Without baking, vertices are left untouched and every instance carries node and basis transform.
+	A mesh no node references gets one instance without a node.
+*/
+static void BuildMeshInstances(const TArray<TArray<FMeshNodeReference>>& References, bool bBakeTransforms, FGLTFRuntimeAsset * MeshData, TArray<FMatrix>& OutVertexTransforms)
+{
+	const FMatrix Basis = GetBasisTransform().ToMatrixWithScale();
+
+	OutVertexTransforms.SetNumUninitialized(References.Num());
+	for (int32 MeshIndex = 0; MeshIndex < References.Num(); ++MeshIndex)
+	{
+		const TArray<FMeshNodeReference>& MeshReferences = References[MeshIndex];
+		const bool bBakeNode = bBakeTransforms && MeshReferences.Num() == 1;
+
+		FMeshInfo& MeshInfo = MeshData->MeshInfo[MeshIndex];
+		if (bBakeTransforms)
+		{
+			OutVertexTransforms[MeshIndex] = bBakeNode ? MeshReferences[0].NodeTransform * Basis : Basis;
+			MeshInfo.RelativeTransform = FTransform(OutVertexTransforms[MeshIndex]);
+		}
+		else
+		{
+			OutVertexTransforms[MeshIndex] = FMatrix::Identity;
+			MeshInfo.RelativeTransform = FTransform(MeshReferences.Num() > 0 ? MeshReferences[0].NodeTransform * Basis : Basis);
+		}
+
+		for (const FMeshNodeReference& Reference : MeshReferences)
+		{
+			FMeshInstance& Instance = MeshData->MeshInstances[MeshData->MeshInstances.AddDefaulted()];
+			Instance.MeshIndex = MeshIndex;
+			Instance.NodeName = Reference.NodeName;
+			Instance.NodeIndex = Reference.NodeIndex;
+			if (!bBakeTransforms)
+			{
+				Instance.Transform = FTransform(Reference.NodeTransform * Basis);
+			}
+			else
+			{
+				Instance.Transform = bBakeNode ? FTransform::Identity : FTransform(ToBasisSpace(Reference.NodeTransform));
+			}
+		}
+
+		// Meshes no node uses are still drawn once, in basis space, as they were before instances existed
+		if (MeshReferences.Num() == 0)
+		{
+			FMeshInstance& Instance = MeshData->MeshInstances[MeshData->MeshInstances.AddDefaulted()];
+			Instance.MeshIndex = MeshIndex;
+			Instance.Transform = bBakeTransforms ? FTransform::Identity : FTransform(Basis);
+		}
+	}
+}
+
+// Appends a part's stream to a batch stream in use, DefaultValue stands in when the part has none
+template<typename ElementType>
+static void AppendStream(TArray<ElementType>& BatchStream, bool bBatchHasStream, const TArray<ElementType>& PartStream, int32 NumVertices, const ElementType& DefaultValue)
+{
+	if (!bBatchHasStream) return;
+	if (PartStream.Num() == NumVertices)
+	{
+		BatchStream.Append(PartStream);
+		return;
+	}
+	for (int32 i = 0; i < NumVertices; ++i)
+	{
+		BatchStream.Add(DefaultValue);
+	}
+}
+
+// Instances of one material going into one merged mesh
+struct FMergeBatch
+{
+	uint32 MaterialIndex = 0;
+	TArray<int32> Instances;
+	int32 NumVertices = 0;
+	int32 NumIndices = 0;
+};
+
+static void BuildMergedMesh(const FGLTFRuntimeAsset * MeshData, const FMergeBatch& Batch, bool bCompactIndices, FMeshInfo& OutMesh)
+{
+	bool bNormals = false, bTangents = false, bUV0 = false, bUV1 = false, bColors = false;
+	for (int32 InstanceIndex : Batch.Instances)
+	{
+		const FMeshInfo& Part = MeshData->MeshInfo[MeshData->MeshInstances[InstanceIndex].MeshIndex];
+		bNormals |= Part.Normals.Num() > 0;
+		bTangents |= Part.Tangents.Num() > 0;
+		bUV0 |= Part.UV0.Num() > 0;
+		bUV1 |= Part.UV1.Num() > 0;
+		bColors |= Part.VertexColors.Num() > 0;
+	}
+
+	OutMesh.MaterialIndex = Batch.MaterialIndex;
+	OutMesh.RelativeTransform = FTransform::Identity;
+	OutMesh.Vertices.Reserve(Batch.NumVertices);
+	OutMesh.Triangles.Reserve(Batch.NumIndices);
+	OutMesh.Parts.Reserve(Batch.Instances.Num());
+
+	for (int32 InstanceIndex : Batch.Instances)
+	{
+		const FMeshInstance& Instance = MeshData->MeshInstances[InstanceIndex];
+		FMeshInfo Part = MeshData->MeshInfo[Instance.MeshIndex];
+		if (!Instance.Transform.Equals(FTransform::Identity))
+		{
+			Part.TransformBy(Instance.Transform);
+		}
+
+		const int32 NumVertices = Part.Vertices.Num();
+		FMergedPart& MergedPart = OutMesh.Parts[OutMesh.Parts.AddDefaulted()];
+		MergedPart.Name = Instance.NodeName.IsEmpty() ? Part.Name : Instance.NodeName;
+		MergedPart.NodeIndex = Instance.NodeIndex;
+		MergedPart.FirstIndex = OutMesh.Triangles.Num();
+		MergedPart.NumIndices = Part.GetNumIndices();
+		MergedPart.FirstVertex = OutMesh.Vertices.Num();
+		MergedPart.NumVertices = NumVertices;
+
+		OutMesh.Vertices.Append(Part.Vertices);
+		AppendStream(OutMesh.Normals, bNormals, Part.Normals, NumVertices, FVector::UpVector);
+		AppendStream(OutMesh.Tangents, bTangents, Part.Tangents, NumVertices, FProcMeshTangent());
+		AppendStream(OutMesh.UV0, bUV0, Part.UV0, NumVertices, FVector2D::ZeroVector);
+		AppendStream(OutMesh.UV1, bUV1, Part.UV1, NumVertices, FVector2D::ZeroVector);
+		AppendStream(OutMesh.VertexColors, bColors, Part.VertexColors, NumVertices, FLinearColor::White);
+
+		for (int32 i = 0; i < MergedPart.NumIndices; ++i)
+		{
+			OutMesh.Triangles.Add(MergedPart.FirstVertex + (Part.Triangles16.Num() > 0 ? Part.Triangles16[i] : Part.Triangles[i]));
+		}
+	}
+
+	if (bCompactIndices)
+	{
+		OutMesh.NarrowIndices();
+	}
+}
+
+// Replaces small meshes by per material batches, see FGLTFImportOptions::bMergeByMaterial
+static void MergeMeshesByMaterial(FGLTFRuntimeAsset * MeshData, const FGLTFImportOptions& Options)
+{
+	const int32 NumMeshes = MeshData->MeshInfo.Num();
+	TArray<int32> NumMeshInstances;
+	NumMeshInstances.SetNumZeroed(NumMeshes);
+	for (const FMeshInstance& Instance : MeshData->MeshInstances)
+	{
+		++NumMeshInstances[Instance.MeshIndex];
+	}
+
+	// Batches fill up in instance order, a full one is replaced by a new batch of the same material
+	TArray<FMergeBatch> Batches;
+	TMap<uint32, int32> OpenBatches;
+	for (int32 InstanceIndex = 0; InstanceIndex < MeshData->MeshInstances.Num(); ++InstanceIndex)
+	{
+		const int32 MeshIndex = MeshData->MeshInstances[InstanceIndex].MeshIndex;
+		const FMeshInfo& MeshInfo = MeshData->MeshInfo[MeshIndex];
+		const int32 NumVertices = MeshInfo.Vertices.Num();
+		const int32 NumIndices = MeshInfo.GetNumIndices();
+		if (NumVertices == 0 || NumVertices > Options.MaxMergePartVertices) continue;
+		if (NumMeshInstances[MeshIndex] > 1 && !Options.bMergeInstancedMeshes) continue;
+
+		int32* BatchIndex = OpenBatches.Find(MeshInfo.MaterialIndex);
+		if (!BatchIndex
+			|| Batches[*BatchIndex].NumVertices + NumVertices > Options.MaxMergedVertices
+			|| Batches[*BatchIndex].NumIndices + NumIndices > Options.MaxMergedTriangles * 3)
+		{
+			BatchIndex = &OpenBatches.Add(MeshInfo.MaterialIndex, Batches.AddDefaulted());
+			Batches[*BatchIndex].MaterialIndex = MeshInfo.MaterialIndex;
+		}
+		FMergeBatch& Batch = Batches[*BatchIndex];
+		Batch.Instances.Add(InstanceIndex);
+		Batch.NumVertices += NumVertices;
+		Batch.NumIndices += NumIndices;
+	}
+
+	// A batch of one part would only lose its LODs
+	Batches.RemoveAll([](const FMergeBatch& Batch) { return Batch.Instances.Num() < 2; });
+	if (Batches.Num() == 0) return;
+
+	TArray<FMeshInfo> MergedMeshes;
+	MergedMeshes.SetNum(Batches.Num());
+	ParallelFor(Batches.Num(), [&](int32 BatchIndex)
+	{
+		BuildMergedMesh(MeshData, Batches[BatchIndex], Options.bCompactIndices, MergedMeshes[BatchIndex]);
+		MergedMeshes[BatchIndex].Name = FString::Printf(TEXT("Merged_%u_%d"), Batches[BatchIndex].MaterialIndex, BatchIndex);
+	});
+
+	TArray<bool> bInstanceMerged;
+	bInstanceMerged.SetNumZeroed(MeshData->MeshInstances.Num());
+	for (const FMergeBatch& Batch : Batches)
+	{
+		for (int32 InstanceIndex : Batch.Instances)
+		{
+			bInstanceMerged[InstanceIndex] = true;
+		}
+	}
+
+	// Meshes that still have unmerged instances stay, in their old order, batches go after them
+	TArray<bool> bMeshKept;
+	bMeshKept.SetNumZeroed(NumMeshes);
+	for (int32 InstanceIndex = 0; InstanceIndex < MeshData->MeshInstances.Num(); ++InstanceIndex)
+	{
+		if (!bInstanceMerged[InstanceIndex])
+		{
+			bMeshKept[MeshData->MeshInstances[InstanceIndex].MeshIndex] = true;
+		}
+	}
+
+	const bool bHasLODs = MeshData->MeshLODs.Num() > 0;
+	TArray<int32> NewMeshIndex;
+	NewMeshIndex.Init(INDEX_NONE, NumMeshes);
+	TArray<FMeshInfo> NewMeshInfo;
+	TArray<TArray<FMeshLOD>> NewMeshLODs;
+	for (int32 MeshIndex = 0; MeshIndex < NumMeshes; ++MeshIndex)
+	{
+		if (!bMeshKept[MeshIndex]) continue;
+		NewMeshIndex[MeshIndex] = NewMeshInfo.Add(MoveTemp(MeshData->MeshInfo[MeshIndex]));
+		if (bHasLODs)
+		{
+			NewMeshLODs.Add(MoveTemp(MeshData->MeshLODs[MeshIndex]));
+		}
+	}
+
+	TArray<FMeshInstance> NewInstances;
+	for (int32 InstanceIndex = 0; InstanceIndex < MeshData->MeshInstances.Num(); ++InstanceIndex)
+	{
+		if (bInstanceMerged[InstanceIndex]) continue;
+		FMeshInstance& Instance = NewInstances[NewInstances.Add(MeshData->MeshInstances[InstanceIndex])];
+		Instance.MeshIndex = NewMeshIndex[Instance.MeshIndex];
+	}
+	for (FMeshInfo& MergedMesh : MergedMeshes)
+	{
+		FMeshInstance& Instance = NewInstances[NewInstances.AddDefaulted()];
+		Instance.NodeName = MergedMesh.Name;
+		Instance.MeshIndex = NewMeshInfo.Add(MoveTemp(MergedMesh));
+		if (bHasLODs)
+		{
+			NewMeshLODs.AddDefaulted();
+		}
+	}
+
+	// Merged parts are found through FMeshInfo::Parts now, nodes only list what they still draw themselves
+	for (FGLTFNode& Node : MeshData->Nodes)
+	{
+		Node.MeshIndices.Reset();
+	}
+	for (const FMeshInstance& Instance : NewInstances)
+	{
+		if (MeshData->Nodes.IsValidIndex(Instance.NodeIndex))
+		{
+			MeshData->Nodes[Instance.NodeIndex].MeshIndices.AddUnique(Instance.MeshIndex);
+		}
+	}
+
+	MeshData->MeshInfo = MoveTemp(NewMeshInfo);
+	MeshData->MeshLODs = MoveTemp(NewMeshLODs);
+	MeshData->MeshInstances = MoveTemp(NewInstances);
+}
+
 //#if PLATFORM_ANDROID || PLATFORM_IOS
-void ImportMeshes(FGLTFRuntimeAsset * MeshData, const struct aiScene * ImportedScene)
+// Returns false if the job was cancelled before all meshes were converted
+bool ImportMeshes(FGLTFRuntimeAsset * MeshData, const struct aiScene * ImportedScene, FAssimpImportJob& Job)
 {
-	if (!MeshData) return;
-	MeshData->MeshInfo.SetNum(ImportedScene->mNumMeshes, false);
+	if (!MeshData) return false;
+	const int32 NumMeshes = ImportedScene->mNumMeshes;
+	MeshData->MeshInfo.SetNum(NumMeshes, false);
 
-	for (uint32 i = 0; i < ImportedScene->mNumMeshes; ++i)
+	for (int32 i = 0; i < NumMeshes; ++i)
 	{
 		MeshData->MeshInfo[i].MaterialIndex = ImportedScene->mMeshes[i]->mMaterialIndex;
 		MeshData->MeshInfo[i].Name = FString(UTF8_TO_TCHAR(ImportedScene->mMeshes[i]->mName.C_Str()));
 	}
 
-	FindMesh(ImportedScene, ImportedScene->mRootNode, MeshData);
+	Job.ReportProgress(EAssimpImportPhase::Meshes, 0.0f);
+
+	TArray<TArray<FMeshNodeReference>> References;
+	References.SetNum(NumMeshes);
+	FindMesh(ImportedScene, MeshData, References, Job);
+	if (Job.IsCancelled()) return false;
 
-	for (uint32 i = 0; i < ImportedScene->mNumMeshes; ++i)
+	TArray<FMatrix> VertexTransforms;
+	BuildMeshInstances(References, Job.GetOptions().bBakeTransforms, MeshData, VertexTransforms);
+
+	// Every mesh writes only its own FMeshInfo slot, so output order does not depend on scheduling
+	const FGLTFImportOptions& Options = Job.GetOptions();
+	const bool bCompactIndices = Options.bCompactIndices;
+	FThreadSafeCounter NumConverted;
+	FThreadSafeCounter64 NumVerticesBeforeWeld;
+	FThreadSafeCounter64 NumVerticesAfterWeld;
+	MeshData->MeshLODs.SetNum(Options.bGenerateLODs ? NumMeshes : 0);
+	GLTFMeshConversion::ParallelForMeshes(ImportedScene->mMeshes, NumMeshes, [&](int32 i)
 	{
+		if (Job.IsCancelled()) return;
+
+		const aiMesh * Mesh = ImportedScene->mMeshes[i];
+		FMeshInfo& MeshInfo = MeshData->MeshInfo[i];
+		GLTFMeshConversion::ConvertVertices(Mesh, VertexTransforms[i], MeshInfo);
+
 		//Triangle number
-		for (uint32 l = 0; l < ImportedScene->mMeshes[i]->mNumFaces; ++l)
+		if (Options.bWeldVertices || Options.bGenerateLODs)
 		{
-			for (uint32 m = 0; m < ImportedScene->mMeshes[i]->mFaces[l].mNumIndices; ++m)
+			// Welding and simplification need the full width indices, narrowing happens once the vertex counts are final
+			GLTFMeshConversion::ConvertIndices(Mesh, MeshInfo.Triangles);
+			MeshInfo.Triangles16.Reset();
+			if (Options.bWeldVertices)
+			{
+				NumVerticesBeforeWeld.Add(MeshInfo.Vertices.Num());
+				GLTFMeshConversion::WeldVertices(MeshInfo, Options);
+				NumVerticesAfterWeld.Add(MeshInfo.Vertices.Num());
+			}
+			if (Options.bGenerateLODs && !Job.IsCancelled())
 			{
-				MeshData->MeshInfo[i].Triangles.Push(ImportedScene->mMeshes[i]->mFaces[l].mIndices[m]);
+				GLTFMeshSimplifier::BuildLODChain(MeshInfo, Options, MeshData->MeshLODs[i]);
 			}
+			if (bCompactIndices)
+			{
+				MeshInfo.NarrowIndices();
+				if (Options.bGenerateLODs)
+				{
+					for (FMeshLOD& LOD : MeshData->MeshLODs[i])
+					{
+						LOD.Mesh.NarrowIndices();
+					}
+				}
+			}
+		}
+		else if (bCompactIndices && Mesh->mNumVertices <= MAX_uint16 + 1)
+		{
+			GLTFMeshConversion::ConvertIndices(Mesh, MeshInfo.Triangles16);
+			MeshInfo.Triangles.Reset();
+		}
+		else
+		{
+			GLTFMeshConversion::ConvertIndices(Mesh, MeshInfo.Triangles);
+			MeshInfo.Triangles16.Reset();
+		}
+
+		Job.ReportProgress(EAssimpImportPhase::Meshes, (float)NumConverted.Increment() / NumMeshes);
+	});
+
+	if (Job.IsCancelled()) return false;
+
+	if (Options.bWeldVertices)
+	{
+		MeshData->Stats.NumVerticesBeforeWeld = NumVerticesBeforeWeld.GetValue();
+		MeshData->Stats.NumVerticesAfterWeld = NumVerticesAfterWeld.GetValue();
+		UE_LOG(LogTemp, Log, TEXT("Vertex welding: %lld -> %lld vertices (%.1f%% removed)"),
+			MeshData->Stats.NumVerticesBeforeWeld, MeshData->Stats.NumVerticesAfterWeld,
+			MeshData->Stats.NumVerticesBeforeWeld > 0 ? 100.0 * (MeshData->Stats.NumVerticesBeforeWeld - MeshData->Stats.NumVerticesAfterWeld) / MeshData->Stats.NumVerticesBeforeWeld : 0.0);
+	}
+	else
+	{
+		int64 NumVertices = 0;
+		for (const FMeshInfo& MeshInfo : MeshData->MeshInfo)
+		{
+			NumVertices += MeshInfo.Vertices.Num();
 		}
+		MeshData->Stats.NumVerticesBeforeWeld = NumVertices;
+		MeshData->Stats.NumVerticesAfterWeld = NumVertices;
+	}
+
+	MeshData->Stats.NumSectionsBeforeMerge = MeshData->MeshInstances.Num();
+	if (Options.bMergeByMaterial)
+	{
+		MergeMeshesByMaterial(MeshData, Options);
+		UE_LOG(LogTemp, Log, TEXT("Merge by material: %d -> %d sections"), MeshData->Stats.NumSectionsBeforeMerge, MeshData->MeshInstances.Num());
+	}
+	MeshData->Stats.NumSectionsAfterMerge = MeshData->MeshInstances.Num();
 
+	// Collision data is prepared on the final meshes, so merged batches get theirs too
+	MeshData->CollisionMode = Options.CollisionMode;
+	if (Options.CollisionMode != EGLTFCollisionMode::None)
+	{
+		ParallelFor(MeshData->MeshInfo.Num(), [&](int32 MeshIndex)
+		{
+			FMeshInfo& MeshInfo = MeshData->MeshInfo[MeshIndex];
+			if (Options.CollisionMode == EGLTFCollisionMode::ConvexHulls)
+			{
+				GLTFMeshConversion::ComputeHullPoints(MeshInfo.Vertices, FMath::Max(Options.MaxHullVertices, 4), MeshInfo.ConvexHull);
+			}
+			MeshInfo.CollisionHash = GLTFMeshConversion::ComputeGeometryHash(MeshInfo, (uint8)Options.CollisionMode);
+		});
 	}
+
+	Job.ReportProgress(EAssimpImportPhase::Meshes, 1.0f);
 	MeshData->bSuccess = true;
+	return true;
 }
 //#endif
 
-uint32 FAssimpImport::Run()
+FAssimpImportJob::FAssimpImportJob(FString NewFilePath, const FGLTFImportOptions& NewOptions, FOnImportComplete NewOnImportComplete, FOnImportProgress NewOnImportProgress, EAssimpImportPriority NewPriority, uint64 NewSequence)
+	: FilePath(NewFilePath)
+	, Options(NewOptions)
+	, OnImportComplete(NewOnImportComplete)
+	, OnImportProgress(NewOnImportProgress)
+	, Priority(NewPriority)
+	, Sequence(NewSequence)
+	, GLTFAsset(nullptr)
+	, PhaseStartTime(FPlatformTime::Seconds())
+	, LastProgressBroadcastTime(0.0)
+{
+	Progress.FilePath = FilePath;
+}
+
+void FAssimpImportJob::ReportProgress(EAssimpImportPhase Phase, float PhaseFraction)
+{
+	if (!OnImportProgress.IsBound()) return;
+
+	const double Now = FPlatformTime::Seconds();
+	FAssimpImportProgress Snapshot;
+	{
+		FScopeLock Lock(&ProgressCriticalSection);
+
+		// Phases only move forward, late callbacks from a finished phase are dropped
+		if (Phase < Progress.Phase) return;
+
+		const bool bPhaseChanged = Phase != Progress.Phase;
+		if (bPhaseChanged)
+		{
+			Progress.PhaseSeconds[(int32)Progress.Phase] += Now - PhaseStartTime;
+			PhaseStartTime = Now;
+			Progress.Phase = Phase;
+		}
+
+		Progress.PhaseProgress = FMath::Clamp(PhaseFraction, 0.0f, 1.0f);
+		Progress.Progress = 0.0f;
+		for (int32 i = 0; i < (int32)EAssimpImportPhase::Done; ++i)
+		{
+			if (i < (int32)Phase) Progress.Progress += ImportPhaseWeights[i];
+			else if (i == (int32)Phase) Progress.Progress += ImportPhaseWeights[i] * Progress.PhaseProgress;
+		}
+
+		if (!bPhaseChanged && Now - LastProgressBroadcastTime < ImportProgressIntervalSeconds)
+		{
+			return;
+		}
+		LastProgressBroadcastTime = Now;
+		Snapshot = Progress;
+	}
+
+	if (IsInGameThread())
+	{
+		OnImportProgress.Broadcast(Snapshot);
+	}
+	else
+	{
+		TSharedRef<FAssimpImportJob, ESPMode::ThreadSafe> ThisJob = AsShared();
+		AsyncTask(ENamedThreads::GameThread, [ThisJob, Snapshot]()
+		{
+			ThisJob->OnImportProgress.Broadcast(Snapshot);
+		});
+	}
+}
+
+FAssimpImportWorker::FAssimpImportWorker(FAssimpImport& InQueue, int32 WorkerIndex)
+	: Queue(InQueue)
+	, bRunning(true)
+{
+	Thread = FRunnableThread::Create(this, *FString::Printf(TEXT("AssimpImport%d"), WorkerIndex));
+}
+
+FAssimpImportWorker::~FAssimpImportWorker()
+{
+	bRunning = false;
+	if (Thread)
+	{
+		delete Thread;
+		Thread = nullptr;
+	}
+}
+
+uint32 FAssimpImportWorker::Run()
+{
+	while (bRunning)
+	{
+		FAssimpImportJobPtr Job = Queue.DequeueJob(AssimpWorkerIdleWaitMs);
+		if (Job.IsValid())
+		{
+			Queue.ExecuteJob(Job);
+			Queue.FinishJob(Job);
+		}
+	}
+	return 0;
+}
+
+void FAssimpImportWorker::WaitForCompletion()
+{
+	if (Thread)
+	{
+		Thread->WaitForCompletion();
+	}
+}
+
+void FAssimpImport::Startup()
+{
+	// SetNumWorkers is game thread only, so the instance is not created lazily from whichever thread asks first
+	check(IsInGameThread());
+	if (!Instance)
+	{
+		Instance = new FAssimpImport();
+	}
+}
+
+FAssimpImport& FAssimpImport::Get()
+{
+	check(Instance);
+	return *Instance;
+}
+
+void FAssimpImport::Shutdown()
+{
+	if (Instance)
+	{
+		delete Instance;
+		Instance = nullptr;
+	}
+}
+
+FAssimpImport::FAssimpImport()
+	: WorkAvailableEvent(FPlatformProcess::GetSynchEventFromPool(false))
+	, NextSequence(0)
+{
+	// Leave cores for the game and render threads, Assimp parsing is mostly memory bound anyway
+	SetNumWorkers(FMath::Clamp(FPlatformMisc::NumberOfCores() - 2, 1, 4));
+}
+
+FAssimpImport::~FAssimpImport()
+{
+	{
+		// Running jobs stop at their next IsCancelled check, so the workers are not held up by mesh and material conversion
+		FScopeLock Lock(&QueueCriticalSection);
+		for (const FAssimpImportJobPtr& Job : PendingJobs)
+		{
+			Job->bCancelled = true;
+		}
+		for (const FAssimpImportJobPtr& Job : RunningJobs)
+		{
+			Job->bCancelled = true;
+		}
+		PendingJobs.Empty();
+	}
+	StopWorkers(0);
+	FPlatformProcess::ReturnSynchEventToPool(WorkAvailableEvent);
+	WorkAvailableEvent = nullptr;
+}
+
+void FAssimpImport::SetNumWorkers(int32 NumWorkers)
+{
+	check(IsInGameThread());
+	NumWorkers = FMath::Max(NumWorkers, 1);
+
+	if (NumWorkers < Workers.Num())
+	{
+		StopWorkers(NumWorkers);
+	}
+
+	while (Workers.Num() < NumWorkers)
+	{
+		Workers.Add(new FAssimpImportWorker(*this, Workers.Num()));
+	}
+}
+
+int32 FAssimpImport::GetNumPendingJobs()
+{
+	FScopeLock Lock(&QueueCriticalSection);
+	return PendingJobs.Num();
+}
+
+void FAssimpImport::CancelJob(const FAssimpImportJobPtr& Job)
 {
-	//FPlatformProcess::Sleep(0.03f);
-    //#if PLATFORM_ANDROID || PLATFORM_IOS
+	if (!Job.IsValid()) return;
+
+	FScopeLock Lock(&QueueCriticalSection);
+	Job->bCancelled = true;
+	PendingJobs.RemoveSingle(Job);
+}
+
+void FAssimpImport::SetJobPriority(const FAssimpImportJobPtr& Job, EAssimpImportPriority NewPriority)
+{
+	if (!Job.IsValid()) return;
+
+	// DequeueJob reads priorities under the same lock
+	FScopeLock Lock(&QueueCriticalSection);
+	Job->Priority = NewPriority;
+}
+
+void FAssimpImport::StopWorkers(int32 FirstWorker)
+{
+	for (int32 i = FirstWorker; i < Workers.Num(); ++i)
+	{
+		Workers[i]->Stop();
+	}
+	for (int32 i = FirstWorker; i < Workers.Num(); ++i)
+	{
+		WorkAvailableEvent->Trigger();
+		Workers[i]->WaitForCompletion();
+		delete Workers[i];
+	}
+	Workers.SetNum(FMath::Min(FirstWorker, Workers.Num()));
+}
+
+FAssimpImportJobPtr FAssimpImport::EnqueueJob(FString NewFilePath, const FGLTFImportOptions& Options, FOnImportComplete NewOnImportComplete, FOnImportProgress NewOnImportProgress, EAssimpImportPriority Priority)
+{
+	FAssimpImportJobPtr Job;
+	{
+		FScopeLock Lock(&QueueCriticalSection);
+		Job = MakeShareable(new FAssimpImportJob(NewFilePath, Options, NewOnImportComplete, NewOnImportProgress, Priority, NextSequence++));
+		PendingJobs.Add(Job);
+	}
+	WorkAvailableEvent->Trigger();
+	return Job;
+}
+
+FAssimpImportJobPtr FAssimpImport::DequeueJob(uint32 WaitMs)
+{
+	for (int32 Attempt = 0; Attempt < 2; ++Attempt)
+	{
+		{
+			FScopeLock Lock(&QueueCriticalSection);
+			int32 BestIndex = INDEX_NONE;
+			for (int32 i = 0; i < PendingJobs.Num(); ++i)
+			{
+				const FAssimpImportJob& Candidate = *PendingJobs[i];
+				if (BestIndex == INDEX_NONE
+					|| Candidate.Priority > PendingJobs[BestIndex]->Priority
+					|| (Candidate.Priority == PendingJobs[BestIndex]->Priority && Candidate.Sequence < PendingJobs[BestIndex]->Sequence))
+				{
+					BestIndex = i;
+				}
+			}
+
+			if (BestIndex != INDEX_NONE)
+			{
+				FAssimpImportJobPtr Job = PendingJobs[BestIndex];
+				PendingJobs.RemoveAt(BestIndex, 1, false);
+				RunningJobs.Add(Job);
+				// Wake another worker if there is more to do
+				if (PendingJobs.Num() > 0)
+				{
+					WorkAvailableEvent->Trigger();
+				}
+				return Job;
+			}
+		}
+
+		if (Attempt == 0)
+		{
+			WorkAvailableEvent->Wait(WaitMs);
+		}
+	}
+	return nullptr;
+}
+
+void FAssimpImport::FinishJob(const FAssimpImportJobPtr& Job)
+{
+	FScopeLock Lock(&QueueCriticalSection);
+	RunningJobs.RemoveSingleSwap(Job, false);
+}
+
+void FAssimpImport::ExecuteJob(const FAssimpImportJobPtr& Job)
+{
+	if (Job->IsCancelled()) return;
+
+	FGLTFRuntimeAsset * GLTFAsset = nullptr;
+	FGLTFImportStats Stats;
 	{
-		FScopeLock Lock(&ImportCriticalSection);
-     
 		aiString CFilePath;
-		CFilePath = TCHAR_TO_UTF8(*FilePath);
-  
+		CFilePath = TCHAR_TO_UTF8(*Job->FilePath);
+
 		Assimp::Importer Importer;
-		const aiScene* ImportedScene = Importer.ReadFile(CFilePath.C_Str(), 
-			aiProcess_Triangulate | aiProcess_GenSmoothNormals | aiProcess_MakeLeftHanded | aiProcess_GenUVCoords | aiProcess_CalcTangentSpace | aiProcess_OptimizeMeshes);
+		Importer.SetProgressHandler(new FAssimpProgressHandler(*Job));
+		SetImporterProperties(Importer, Job->Options);
+		Job->ReportProgress(EAssimpImportPhase::Read, 0.0f);
+
+		const FGLTFImportOptions& Options = Job->Options;
+		const uint32 RenderOptimizationFlags = aiProcess_SplitLargeMeshes | aiProcess_ImproveCacheLocality;
+		uint32 PostProcessFlags = GetPostProcessFlags(Options);
+		const bool bMeasureCache = (PostProcessFlags & RenderOptimizationFlags) != 0 && Options.bOptimizeForRendering;
+		const aiScene* ImportedScene = nullptr;
+		if (Options.bSkipRedundantSteps || bMeasureCache)
+		{
+			// Read unprocessed, look at what the file ships, then post-process with what is left.
+			// Splitting and cache optimization run as a second pass so the ACMR can be measured around them.
+			uint32 FirstPassFlags = bMeasureCache ? PostProcessFlags & ~RenderOptimizationFlags : PostProcessFlags;
+			ImportedScene = Importer.ReadFile(CFilePath.C_Str(), 0);
+			if (ImportedScene && !Job->IsCancelled())
+			{
+				if (Options.bSkipRedundantSteps)
+				{
+					FirstPassFlags = SkipRedundantSteps(ImportedScene, FirstPassFlags);
+				}
+				ImportedScene = Importer.ApplyPostProcessing(FirstPassFlags);
+			}
+			if (bMeasureCache && ImportedScene && !Job->IsCancelled())
+			{
+				Stats.NumMeshesBeforeSplit = ImportedScene->mNumMeshes;
+				Stats.ACMRBefore = GLTFMeshConversion::ComputeACMR(ImportedScene->mMeshes, ImportedScene->mNumMeshes, Options.VertexCacheSize);
+				ImportedScene = Importer.ApplyPostProcessing(PostProcessFlags & RenderOptimizationFlags);
+				if (ImportedScene)
+				{
+					Stats.NumMeshesAfterSplit = ImportedScene->mNumMeshes;
+					Stats.ACMRAfter = GLTFMeshConversion::ComputeACMR(ImportedScene->mMeshes, ImportedScene->mNumMeshes, Options.VertexCacheSize);
+					UE_LOG(LogTemp, Log, TEXT("Render optimization: %d -> %d meshes, ACMR %.3f -> %.3f"),
+						Stats.NumMeshesBeforeSplit, Stats.NumMeshesAfterSplit, Stats.ACMRBefore, Stats.ACMRAfter);
+				}
+			}
+			PostProcessFlags = FirstPassFlags | (bMeasureCache ? PostProcessFlags & RenderOptimizationFlags : 0);
+		}
+		else
+		{
+			ImportedScene = Importer.ReadFile(CFilePath.C_Str(), PostProcessFlags);
+		}
+		UE_LOG(LogTemp, Log, TEXT("Post-process flags for %s: 0x%08x"), *Job->FilePath, PostProcessFlags);
+
+		if (Job->IsCancelled())
+		{
+			UE_LOG(LogTemp, Log, TEXT("Import cancelled: %s."), *Job->FilePath);
+			return;
+		}
 
 		if (ImportedScene == nullptr)
 		{
 			UE_LOG(LogTemp, Warning, TEXT("ImportError: %s."), UTF8_TO_TCHAR(Importer.GetErrorString()));
-			return -1;
 		}
-		UE_LOG(LogTemp, Warning, TEXT("Geometry imported."));
-		GLTFAsset = new FGLTFRuntimeAsset();
+		else if (ImportedScene->HasMeshes())
+		{
+			UE_LOG(LogTemp, Warning, TEXT("Geometry imported."));
+			GLTFAsset = new FGLTFRuntimeAsset();
+			GLTFAsset->Stats = Stats;
+			if (!ImportMeshes(GLTFAsset, ImportedScene, *Job))
+			{
+				UE_LOG(LogTemp, Log, TEXT("Import cancelled: %s."), *Job->FilePath);
+				delete GLTFAsset;
+				return;
+			}
+		}
+	}
 
-		if (ImportedScene->HasMeshes())
+	Job->GLTFAsset = GLTFAsset;
+	Job->bFinished = true;
+
+	UE_LOG(LogTemp, Warning, TEXT("Exit geometry load."));
+
+	// Listeners create UObjects, so completion always runs on the game thread
+	FAssimpImportJobPtr FinishedJob = Job;
+	AsyncTask(ENamedThreads::GameThread, [FinishedJob]()
+	{
+		// Cancelled while the task was in flight, nobody will take ownership of the asset
+		if (FinishedJob->IsCancelled())
 		{
-			ImportMeshes(GLTFAsset, ImportedScene);
-			Exit();
+			delete FinishedJob->GLTFAsset;
+			FinishedJob->GLTFAsset = nullptr;
 		}
 		else
-			return -1;
+		{
+			FinishedJob->OnImportComplete.Broadcast(FinishedJob->GLTFAsset);
+		}
+		FinishedJob->OnImportComplete.Clear();
+	});
+}
+
+FGLTFImportHandle::FGLTFImportHandle(FAssimpImportJobPtr InJob, UGLTFRuntimeImporter* InImporter)
+	: Job(InJob)
+	, Importer(InImporter)
+{
+}
+
+void FGLTFImportHandle::Cancel()
+{
+	// After shutdown every job was cancelled already
+	if (FAssimpImport::IsRunning())
+	{
+		FAssimpImport::Get().CancelJob(Job);
+	}
+	if (UGLTFRuntimeImporter* Owner = Importer.Get())
+	{
+		check(IsInGameThread());
+		Owner->ActiveJobs.RemoveSingle(Job);
 	}
-//#endif
-	return 0;
 }
 
-bool UGLTFRuntimeImporter::LoadAsset(FString Filepath)
+void FGLTFImportHandle::SetPriority(EAssimpImportPriority NewPriority)
+{
+	if (FAssimpImport::IsRunning())
+	{
+		FAssimpImport::Get().SetJobPriority(Job, NewPriority);
+	}
+}
+
+FGLTFImportHandle UGLTFRuntimeImporter::LoadAsset(FString Filepath, EAssimpImportPriority Priority, const FGLTFImportOptions& Options)
 {
 	if (Filepath.IsEmpty())
 	{
 		UE_LOG(LogTemp, Warning, TEXT("Runtime Mesh Loader: filepath is empty."));
-		return false;
+		return FGLTFImportHandle();
 	}
 
 	AssetFilePath = Filepath;
@@ -228,41 +1070,66 @@ bool UGLTFRuntimeImporter::LoadAsset(FString Filepath)
 	FPaths::NormalizeFilename(Filepath);
 	UE_LOG(LogTemp, Warning, TEXT("MLARALOG: Full path: %s"), *Filepath);
 #endif
-	FOnImportComplete OnImportComplete;
-	OnImportComplete.AddUObject(this, &UGLTFRuntimeImporter::OnGeometryLoaded);
 	UE_LOG(LogTemp, Warning, TEXT("Starting importing geometry."));
-	FAssimpImport::StartImport(Filepath, OnImportComplete);
+	FAssimpImportJobPtr Job = FAssimpImport::StartImport(Filepath, FOnImportComplete(), Priority, OnImportProgress, Options);
+	// Weak, the job owns its delegate
+	Job->GetOnImportComplete().AddUObject(this, &UGLTFRuntimeImporter::OnGeometryLoaded, AssetFilePath, TWeakPtr<FAssimpImportJob, ESPMode::ThreadSafe>(Job));
+	ActiveJobs.Add(Job);
 
-	return true;
+	return FGLTFImportHandle(Job, this);
 }
 
-void UGLTFRuntimeImporter::OnGeometryLoaded(FGLTFRuntimeAsset * Asset)
+void UGLTFRuntimeImporter::OnGeometryLoaded(FGLTFRuntimeAsset * Asset, FString SourceFilePath, TWeakPtr<FAssimpImportJob, ESPMode::ThreadSafe> WeakJob)
 {
+	// Other jobs may have finished without broadcasting yet, only this one and cancelled ones, which never report, are done with
+	FAssimpImportJobPtr Job = WeakJob.Pin();
+	ActiveJobs.RemoveAll([&Job](const FAssimpImportJobPtr& ActiveJob) { return ActiveJob == Job || ActiveJob->IsCancelled(); });
+
 	if (Asset)
 	{
 		UE_LOG(LogTemp, Warning, TEXT("Geometry loaded, starting to load materials."));
-		FString FoderPath = FPaths::GetPath(AssetFilePath);
+		FString FoderPath = FPaths::GetPath(SourceFilePath);
 		Asset->Name = FoderPath;
 
 #if PLATFORM_IOS
-		int32 posDoc = AssetFilePath.Find(TEXT("Documents/"), ESearchCase::IgnoreCase, ESearchDir::FromEnd);
-		AssetFilePath = AssetFilePath.Mid(posDoc + 10);
+		int32 posDoc = SourceFilePath.Find(TEXT("Documents/"), ESearchCase::IgnoreCase, ESearchDir::FromEnd);
+		SourceFilePath = SourceFilePath.Mid(posDoc + 10);
 #endif
 
-		GLTFRuntimeMaterials::ImportMaterials(Asset, AssetFilePath);
-		for (auto Material : Asset->Materials)
-			Materials.AddUnique(Material);
-		if (OnImportComplete.IsBound())
+		// Textures are decoded off the game thread, the asset is handed out once its materials exist
+		TWeakObjectPtr<UGLTFRuntimeImporter> WeakThis(this);
+		GLTFRuntimeMaterials::ImportMaterialsAsync(Asset, SourceFilePath, Job, [WeakThis, Asset, Job, SourceFilePath](bool bSuccess)
 		{
-			OnImportComplete.Broadcast(Asset);
-			OnImportComplete.Clear();
-		}
+			UGLTFRuntimeImporter* Importer = WeakThis.Get();
+			if (!bSuccess || !Importer)
+			{
+				UE_LOG(LogTemp, Log, TEXT("Import cancelled during materials: %s."), *SourceFilePath);
+				delete Asset;
+				return;
+			}
+			Importer->OnMaterialsLoaded(Asset, Job);
+		});
 	}
 	else
 		UE_LOG(LogTemp, Warning, TEXT("Failed to load geometry, aborting."));
 
 }
 
+void UGLTFRuntimeImporter::OnMaterialsLoaded(FGLTFRuntimeAsset * Asset, FAssimpImportJobPtr Job)
+{
+	for (auto Material : Asset->Materials)
+		Materials.AddUnique(Material);
+	if (Job.IsValid())
+	{
+		Job->ReportProgress(EAssimpImportPhase::Done, 1.0f);
+	}
+	// Several loads can be in flight on one importer, so the binding stays until the owner removes it
+	if (OnImportComplete.IsBound())
+	{
+		OnImportComplete.Broadcast(Asset);
+	}
+}
+
 FString UGLTFRuntimeImporter::GetAbsolutePathToSaved()
 {
 	FString ExternalDirPath;
@@ -0,0 +1,214 @@
+#include "GLTFStaticMeshBuilder.h"
+#include "Engine/StaticMesh.h"
+#include "StaticMeshResources.h"
+#include "Async/Async.h"
+#include "Async/ParallelFor.h"
+#include "PhysicsEngine/BodySetup.h"
+#include "UObject/GCObject.h"
+#include "UObject/Package.h"
+
+// Cooked body setups by FMeshInfo::CollisionHash, kept alive for the whole process
+class FCollisionCache : public FGCObject
+{
+public:
+	TMap<FSHAHash, UBodySetup*> BodySetups;
+
+	virtual void AddReferencedObjects(FReferenceCollector& Collector) override
+	{
+		Collector.AddReferencedObjects(BodySetups);
+	}
+};
+
+static FCollisionCache& GetCollisionCache()
+{
+	static FCollisionCache Cache;
+	return Cache;
+}
+
+static void BuildLODResources(const FMeshInfo& MeshInfo, FStaticMeshLODResources& LODResources)
+{
+	const int32 NumVertices = MeshInfo.Vertices.Num();
+	const bool bHasNormals = MeshInfo.Normals.Num() == NumVertices;
+	const bool bHasTangents = MeshInfo.Tangents.Num() == NumVertices;
+	const bool bHasUV0 = MeshInfo.UV0.Num() == NumVertices;
+	const bool bHasUV1 = MeshInfo.UV1.Num() == NumVertices;
+	const int32 NumTexCoords = bHasUV1 ? 2 : 1;
+
+	FStaticMeshVertexBuffers& VertexBuffers = LODResources.VertexBuffers;
+	VertexBuffers.PositionVertexBuffer.Init(NumVertices);
+	VertexBuffers.StaticMeshVertexBuffer.Init(NumVertices, NumTexCoords);
+	for (int32 i = 0; i < NumVertices; ++i)
+	{
+		VertexBuffers.PositionVertexBuffer.VertexPosition(i) = MeshInfo.Vertices[i];
+
+		const FVector TangentZ = bHasNormals ? MeshInfo.Normals[i] : FVector::UpVector;
+		FVector TangentX;
+		FVector TangentY;
+		if (bHasTangents)
+		{
+			TangentX = MeshInfo.Tangents[i].TangentX;
+			TangentY = (TangentZ ^ TangentX) * (MeshInfo.Tangents[i].bFlipTangentY ? -1.0f : 1.0f);
+		}
+		else
+		{
+			TangentZ.FindBestAxisVectors(TangentX, TangentY);
+		}
+		VertexBuffers.StaticMeshVertexBuffer.SetVertexTangents(i, TangentX, TangentY, TangentZ);
+		VertexBuffers.StaticMeshVertexBuffer.SetVertexUV(i, 0, bHasUV0 ? MeshInfo.UV0[i] : FVector2D::ZeroVector);
+		if (bHasUV1)
+		{
+			VertexBuffers.StaticMeshVertexBuffer.SetVertexUV(i, 1, MeshInfo.UV1[i]);
+		}
+	}
+
+	if (MeshInfo.VertexColors.Num() == NumVertices)
+	{
+		TArray<FColor> Colors;
+		Colors.SetNumUninitialized(NumVertices);
+		for (int32 i = 0; i < NumVertices; ++i)
+		{
+			Colors[i] = MeshInfo.VertexColors[i].ToFColor(false);
+		}
+		VertexBuffers.ColorVertexBuffer.InitFromColorArray(Colors);
+	}
+
+	const int32 NumIndices = MeshInfo.GetNumIndices();
+	TArray<uint32> Indices;
+	Indices.SetNumUninitialized(NumIndices);
+	for (int32 i = 0; i < NumIndices; ++i)
+	{
+		Indices[i] = MeshInfo.Triangles16.Num() > 0 ? MeshInfo.Triangles16[i] : MeshInfo.Triangles[i];
+	}
+	LODResources.IndexBuffer.SetIndices(Indices, NumVertices <= MAX_uint16 + 1 ? EIndexBufferStride::Force16Bit : EIndexBufferStride::Force32Bit);
+
+	// One material per FMeshInfo, so one section
+	FStaticMeshSection& Section = LODResources.Sections[LODResources.Sections.AddDefaulted()];
+	Section.MaterialIndex = 0;
+	Section.FirstIndex = 0;
+	Section.NumTriangles = NumIndices / 3;
+	Section.MinVertexIndex = 0;
+	Section.MaxVertexIndex = FMath::Max(NumVertices - 1, 0);
+	Section.bEnableCollision = true;
+	Section.bCastShadow = true;
+}
+
+namespace GLTFStaticMeshBuilder
+{
+	TUniquePtr<FStaticMeshRenderData> BuildRenderData(const FGLTFRuntimeAsset& Asset, int32 MeshIndex)
+	{
+		const FMeshInfo& MeshInfo = Asset.MeshInfo[MeshIndex];
+		const int32 NumLODs = FMath::Min(1 + (Asset.MeshLODs.IsValidIndex(MeshIndex) ? Asset.MeshLODs[MeshIndex].Num() : 0), (int32)MAX_STATIC_MESH_LODS);
+
+		TUniquePtr<FStaticMeshRenderData> RenderData = MakeUnique<FStaticMeshRenderData>();
+		RenderData->AllocateLODResources(NumLODs);
+		for (int32 LODIndex = 0; LODIndex < NumLODs; ++LODIndex)
+		{
+			BuildLODResources(Asset.GetLODMesh(MeshIndex, LODIndex), RenderData->LODResources[LODIndex]);
+			RenderData->ScreenSize[LODIndex] = LODIndex == 0 ? 1.0f : Asset.MeshLODs[MeshIndex][LODIndex - 1].ScreenSize;
+		}
+
+		const FBox Box(MeshInfo.Vertices);
+		RenderData->Bounds = FBoxSphereBounds(Box);
+		return RenderData;
+	}
+
+	UStaticMesh* CreateStaticMesh(UObject* Outer, TUniquePtr<FStaticMeshRenderData> RenderData, UMaterialInterface* Material, FName Name, bool bAllowCPUAccess)
+	{
+		check(IsInGameThread());
+
+		UStaticMesh* StaticMesh = NewObject<UStaticMesh>(Outer, Name, RF_Transient);
+		StaticMesh->bAllowCPUAccess = bAllowCPUAccess;
+		StaticMesh->StaticMaterials.Add(FStaticMaterial(Material));
+		StaticMesh->RenderData = MoveTemp(RenderData);
+		StaticMesh->InitResources();
+		StaticMesh->CalculateExtendedBounds();
+		return StaticMesh;
+	}
+
+	void BuildStaticMeshesAsync(const FGLTFRuntimeAsset* Asset, UObject* Outer, TFunction<void(const TArray<UStaticMesh*>&)> OnComplete)
+	{
+		TWeakObjectPtr<UObject> WeakOuter(Outer);
+		AsyncTask(ENamedThreads::AnyBackgroundThreadNormalTask, [Asset, WeakOuter, OnComplete]()
+		{
+			// TUniquePtr cannot be captured by the game thread lambda, so the buffers travel as raw pointers
+			TArray<FStaticMeshRenderData*> RenderData;
+			RenderData.SetNum(Asset->MeshInfo.Num());
+			ParallelFor(RenderData.Num(), [&](int32 MeshIndex)
+			{
+				RenderData[MeshIndex] = BuildRenderData(*Asset, MeshIndex).Release();
+			});
+
+			AsyncTask(ENamedThreads::GameThread, [Asset, WeakOuter, OnComplete, RenderData]()
+			{
+				UObject* Outer = WeakOuter.Get();
+				TArray<UStaticMesh*> StaticMeshes;
+				for (int32 MeshIndex = 0; MeshIndex < RenderData.Num(); ++MeshIndex)
+				{
+					TUniquePtr<FStaticMeshRenderData> MeshRenderData(RenderData[MeshIndex]);
+					if (!Outer) continue;
+
+					const FMeshInfo& MeshInfo = Asset->MeshInfo[MeshIndex];
+					UMaterialInterface* Material = Asset->Materials.IsValidIndex(MeshInfo.MaterialIndex) ? Asset->Materials[MeshInfo.MaterialIndex] : nullptr;
+					const bool bAllowCPUAccess = Asset->CollisionMode == EGLTFCollisionMode::ComplexAsSimple;
+					StaticMeshes.Add(CreateStaticMesh(Outer, MoveTemp(MeshRenderData), Material, NAME_None, bAllowCPUAccess));
+				}
+				if (Outer)
+				{
+					OnComplete(StaticMeshes);
+				}
+			});
+		});
+	}
+
+	void SetupCollision(UStaticMesh* StaticMesh, const FMeshInfo& MeshInfo, EGLTFCollisionMode Mode, TFunction<void()> OnReady)
+	{
+		check(IsInGameThread());
+
+		if (Mode == EGLTFCollisionMode::None)
+		{
+			OnReady();
+			return;
+		}
+
+		FCollisionCache& Cache = GetCollisionCache();
+		if (UBodySetup** Cached = Cache.BodySetups.Find(MeshInfo.CollisionHash))
+		{
+			StaticMesh->BodySetup = *Cached;
+			OnReady();
+			return;
+		}
+
+		// Complex collision reads the triangles through the outer, so the body setup lives in the mesh while it cooks
+		UBodySetup* BodySetup = NewObject<UBodySetup>(StaticMesh, NAME_None, RF_Transient);
+		BodySetup->BodySetupGuid = FGuid::NewGuid();
+		BodySetup->bGenerateMirroredCollision = false;
+		BodySetup->bDoubleSidedGeometry = true;
+		if (Mode == EGLTFCollisionMode::ConvexHulls)
+		{
+			FKConvexElem ConvexElem;
+			ConvexElem.VertexData = MeshInfo.ConvexHull;
+			ConvexElem.UpdateElemBox();
+			BodySetup->AggGeom.ConvexElems.Add(ConvexElem);
+			BodySetup->CollisionTraceFlag = CTF_UseDefault;
+		}
+		else
+		{
+			BodySetup->CollisionTraceFlag = CTF_UseComplexAsSimple;
+		}
+		StaticMesh->BodySetup = BodySetup;
+
+		const FSHAHash Hash = MeshInfo.CollisionHash;
+		BodySetup->CreatePhysicsMeshesAsync(FOnAsyncPhysicsCookFinished::CreateLambda([BodySetup, Hash, OnReady]()
+		{
+			// Cached body setups outlive the mesh they were cooked for, which must not be kept alive through them
+			BodySetup->Rename(nullptr, GetTransientPackage(), REN_DontCreateRedirectors | REN_ForceNoResetLoaders | REN_NonTransactional);
+			GetCollisionCache().BodySetups.Add(Hash, BodySetup);
+			OnReady();
+		}));
+	}
+
+	void ClearCollisionCache()
+	{
+		GetCollisionCache().BodySetups.Empty();
+	}
+}
@@ -0,0 +1,241 @@
+#include "GLTFTextureBuilder.h"
+#include "Engine/Texture2D.h"
+#include "UObject/Package.h"
+#include "RenderUtils.h"
+#include "Async/ParallelFor.h"
+#include "GLTFBlockCompression.h"
+
+// sRGB to linear for every 8 bit value, and linear to sRGB at 12 bit precision
+struct FSRGBTables
+{
+	float ToLinear[256];
+	uint8 ToSRGB[4096];
+
+	FSRGBTables()
+	{
+		for (int32 i = 0; i < 256; ++i)
+		{
+			const float Value = i / 255.0f;
+			ToLinear[i] = Value <= 0.04045f ? Value / 12.92f : FMath::Pow((Value + 0.055f) / 1.055f, 2.4f);
+		}
+		for (int32 i = 0; i < 4096; ++i)
+		{
+			const float Value = i / 4095.0f;
+			const float Encoded = Value <= 0.0031308f ? Value * 12.92f : 1.055f * FMath::Pow(Value, 1.0f / 2.4f) - 0.055f;
+			ToSRGB[i] = (uint8)FMath::Clamp(FMath::RoundToInt(Encoded * 255.0f), 0, 255);
+		}
+	}
+};
+
+static const FSRGBTables& GetSRGBTables()
+{
+	static const FSRGBTables Tables;
+	return Tables;
+}
+
+static FORCEINLINE VectorRegister LoadTexel(const uint8* Texel, EGLTFTextureRole Role, const FSRGBTables& Tables)
+{
+	if (Role == EGLTFTextureRole::Color)
+	{
+		return MakeVectorRegister(Tables.ToLinear[Texel[0]], Tables.ToLinear[Texel[1]], Tables.ToLinear[Texel[2]], Texel[3] / 255.0f);
+	}
+	return MakeVectorRegister(Texel[0] / 255.0f, Texel[1] / 255.0f, Texel[2] / 255.0f, Texel[3] / 255.0f);
+}
+
+static FORCEINLINE void StoreTexel(VectorRegister Value, uint8* Texel, EGLTFTextureRole Role, const FSRGBTables& Tables)
+{
+	if (Role == EGLTFTextureRole::Normal)
+	{
+		// Back to [-1, 1], renormalized so minified normals keep unit length, alpha passes through
+		const VectorRegister Two = MakeVectorRegister(2.0f, 2.0f, 2.0f, 1.0f);
+		const VectorRegister One = MakeVectorRegister(1.0f, 1.0f, 1.0f, 0.0f);
+		VectorRegister Normal = VectorSubtract(VectorMultiply(Value, Two), One);
+		const VectorRegister LengthSquared = VectorDot3(Normal, Normal);
+		Normal = VectorSelect(VectorCompareGT(LengthSquared, GlobalVectorConstants::SmallNumber),
+			VectorMultiply(Normal, VectorReciprocalSqrtAccurate(LengthSquared)), MakeVectorRegister(0.0f, 0.0f, 1.0f, 0.0f));
+		Value = VectorSelect(GlobalVectorConstants::XYZMask, VectorMultiplyAdd(Normal, GlobalVectorConstants::FloatOneHalf, GlobalVectorConstants::FloatOneHalf), Value);
+	}
+
+	float Channels[4];
+	VectorStore(VectorMin(VectorMax(Value, GlobalVectorConstants::FloatZero), GlobalVectorConstants::FloatOne), Channels);
+	for (int32 i = 0; i < 4; ++i)
+	{
+		Texel[i] = Role == EGLTFTextureRole::Color && i < 3
+			? Tables.ToSRGB[FMath::RoundToInt(Channels[i] * 4095.0f)]
+			: (uint8)FMath::RoundToInt(Channels[i] * 255.0f);
+	}
+}
+
+namespace GLTFTextureBuilder
+{
+	void GenerateMips(TArray<FGLTFTextureMip>& Mips, EGLTFTextureRole Role)
+	{
+		check(Mips.Num() == 1);
+		const FSRGBTables& Tables = GetSRGBTables();
+		const VectorRegister Quarter = MakeVectorRegister(0.25f, 0.25f, 0.25f, 0.25f);
+
+		while (Mips.Last().SizeX > 1 || Mips.Last().SizeY > 1)
+		{
+			const int32 ParentIndex = Mips.Num() - 1;
+			FGLTFTextureMip& Mip = Mips[Mips.AddDefaulted()];
+			const FGLTFTextureMip& Parent = Mips[ParentIndex];
+			Mip.SizeX = FMath::Max(Parent.SizeX / 2, 1);
+			Mip.SizeY = FMath::Max(Parent.SizeY / 2, 1);
+			Mip.Data.SetNumUninitialized(Mip.SizeX * Mip.SizeY * 4);
+
+			// An odd or single texel edge reuses its last row or column
+			for (int32 Y = 0; Y < Mip.SizeY; ++Y)
+			{
+				const int32 Y0 = FMath::Min(Y * 2, Parent.SizeY - 1);
+				const int32 Y1 = FMath::Min(Y * 2 + 1, Parent.SizeY - 1);
+				const uint8* Row0 = Parent.Data.GetData() + Y0 * Parent.SizeX * 4;
+				const uint8* Row1 = Parent.Data.GetData() + Y1 * Parent.SizeX * 4;
+				uint8* Out = Mip.Data.GetData() + Y * Mip.SizeX * 4;
+				for (int32 X = 0; X < Mip.SizeX; ++X)
+				{
+					const int32 X0 = FMath::Min(X * 2, Parent.SizeX - 1) * 4;
+					const int32 X1 = FMath::Min(X * 2 + 1, Parent.SizeX - 1) * 4;
+					VectorRegister Sum = VectorAdd(LoadTexel(Row0 + X0, Role, Tables), LoadTexel(Row0 + X1, Role, Tables));
+					Sum = VectorAdd(Sum, VectorAdd(LoadTexel(Row1 + X0, Role, Tables), LoadTexel(Row1 + X1, Role, Tables)));
+					StoreTexel(VectorMultiply(Sum, Quarter), Out + X * 4, Role, Tables);
+				}
+			}
+		}
+	}
+
+	bool HasAlpha(const FGLTFTextureMip& Mip)
+	{
+		for (int32 i = 3; i < Mip.Data.Num(); i += 4)
+		{
+			if (Mip.Data[i] != 255) return true;
+		}
+		return false;
+	}
+
+	EPixelFormat SelectPixelFormat(EGLTFTextureRole Role, bool bHasAlpha, int32 SizeX, int32 SizeY, const FGLTFImportOptions& Options)
+	{
+		// CreateTransient only takes sizes made of whole blocks
+		if (!Options.bCompressTextures || SizeX % 4 != 0 || SizeY % 4 != 0)
+		{
+			return PF_B8G8R8A8;
+		}
+
+		TArray<EPixelFormat, TInlineAllocator<4>> Candidates;
+		if (Role == EGLTFTextureRole::Normal && Options.bTwoChannelNormalMaps)
+		{
+			Candidates.Add(PF_BC5);
+		}
+		if (Role == EGLTFTextureRole::Color && bHasAlpha)
+		{
+			Candidates.Add(PF_DXT5);
+			Candidates.Add(PF_ETC2_RGBA);
+		}
+		else
+		{
+			Candidates.Add(PF_DXT1);
+			Candidates.Add(PF_ETC2_RGB);
+			Candidates.Add(PF_ETC1);
+		}
+
+		for (EPixelFormat Candidate : Candidates)
+		{
+			if (GPixelFormats[Candidate].Supported)
+			{
+				return Candidate;
+			}
+		}
+		return PF_B8G8R8A8;
+	}
+
+	bool CompressMips(TArray<FGLTFTextureMip>& Mips, EPixelFormat PixelFormat, EGLTFTextureCompressionQuality Quality)
+	{
+		int32 BlockBytes;
+		switch (PixelFormat)
+		{
+		case PF_DXT1: case PF_ETC1: case PF_ETC2_RGB: BlockBytes = 8; break;
+		case PF_DXT5: case PF_BC5: case PF_ETC2_RGBA: BlockBytes = 16; break;
+		default: return false;
+		}
+
+		for (FGLTFTextureMip& Mip : Mips)
+		{
+			// The texels are uploaded as B8G8R8A8, so reading them as FColor gives the channels the GPU saw so far
+			const FColor* Texels = reinterpret_cast<const FColor*>(Mip.Data.GetData());
+			const int32 BlocksX = FMath::Max((Mip.SizeX + 3) / 4, 1);
+			const int32 BlocksY = FMath::Max((Mip.SizeY + 3) / 4, 1);
+			TArray<uint8> Blocks;
+			Blocks.SetNumUninitialized(BlocksX * BlocksY * BlockBytes);
+
+			ParallelFor(BlocksY, [&](int32 BlockY)
+			{
+				FColor Block[16];
+				for (int32 BlockX = 0; BlockX < BlocksX; ++BlockX)
+				{
+					// Mips smaller than a block repeat their edge texels
+					for (int32 Y = 0; Y < 4; ++Y)
+					{
+						const int32 SourceY = FMath::Min(BlockY * 4 + Y, Mip.SizeY - 1);
+						for (int32 X = 0; X < 4; ++X)
+						{
+							Block[Y * 4 + X] = Texels[SourceY * Mip.SizeX + FMath::Min(BlockX * 4 + X, Mip.SizeX - 1)];
+						}
+					}
+
+					uint8* Out = Blocks.GetData() + (BlockY * BlocksX + BlockX) * BlockBytes;
+					switch (PixelFormat)
+					{
+					case PF_DXT1: GLTFBlockCompression::EncodeBC1(Block, Out, Quality); break;
+					case PF_DXT5: GLTFBlockCompression::EncodeBC3(Block, Out, Quality); break;
+					case PF_BC5: GLTFBlockCompression::EncodeBC5(Block, Out); break;
+					case PF_ETC1: case PF_ETC2_RGB: GLTFBlockCompression::EncodeETC1(Block, Out, Quality); break;
+					case PF_ETC2_RGBA: GLTFBlockCompression::EncodeETC2RGBA(Block, Out, Quality); break;
+					default: break;
+					}
+				}
+			}, BlocksY < 16);
+			Mip.Data = MoveTemp(Blocks);
+		}
+		return true;
+	}
+
+	UTexture2D* CreateTexture(const FString& BaseName, EPixelFormat PixelFormat, const TArray<FGLTFTextureMip>& Mips)
+	{
+		check(IsInGameThread());
+		if (Mips.Num() == 0) return nullptr;
+
+		UTexture2D* NewTexture = UTexture2D::CreateTransient(Mips[0].SizeX, Mips[0].SizeY, PixelFormat);
+		if (!NewTexture) return nullptr;
+		NewTexture->Rename(*MakeUniqueObjectName(GetTransientPackage(), UTexture2D::StaticClass(), FName(*BaseName)).ToString());
+
+		TIndirectArray<FTexture2DMipMap>& PlatformMips = NewTexture->PlatformData->Mips;
+		for (int32 MipIndex = 0; MipIndex < Mips.Num(); ++MipIndex)
+		{
+			if (MipIndex > 0)
+			{
+				FTexture2DMipMap* NewMip = new FTexture2DMipMap();
+				NewMip->SizeX = Mips[MipIndex].SizeX;
+				NewMip->SizeY = Mips[MipIndex].SizeY;
+				PlatformMips.Add(NewMip);
+			}
+
+			FByteBulkData& BulkData = PlatformMips[MipIndex].BulkData;
+			BulkData.Lock(LOCK_READ_WRITE);
+			void* MipData = BulkData.Realloc(Mips[MipIndex].Data.Num());
+			FMemory::Memcpy(MipData, Mips[MipIndex].Data.GetData(), Mips[MipIndex].Data.Num());
+			BulkData.Unlock();
+		}
+
+		NewTexture->UpdateResource();
+		return NewTexture;
+	}
+
+	int64 GetNumBytes(const TArray<FGLTFTextureMip>& Mips)
+	{
+		int64 NumBytes = 0;
+		for (const FGLTFTextureMip& Mip : Mips)
+		{
+			NumBytes += Mip.Data.Num();
+		}
+		return NumBytes;
+	}
+}
@@ -0,0 +1,135 @@
+#include "GLTFTextureCache.h"
+#include "Engine/Texture2D.h"
+#include "HAL/FileManager.h"
+#include "Misc/Paths.h"
+
+FGLTFTextureCache& FGLTFTextureCache::Get()
+{
+	static FGLTFTextureCache Cache;
+	return Cache;
+}
+
+FString FGLTFTextureCache::MakePathKey(const FString& ImagePath)
+{
+	FString Path = FPaths::ConvertRelativePathToFull(ImagePath);
+	FPaths::NormalizeFilename(Path);
+	FPaths::CollapseRelativeDirectories(Path);
+#if PLATFORM_WINDOWS || PLATFORM_MAC
+	Path.ToLowerInline();
+#endif
+	return Path + TEXT("|") + IFileManager::Get().GetTimeStamp(*ImagePath).ToString();
+}
+
+FGLTFTextureCache::FEntry* FGLTFTextureCache::AcquireEntry(const FSHAHash& ContentHash, int32 NumReferences)
+{
+	FEntry* Entry = Entries.Find(ContentHash);
+	if (Entry)
+	{
+		Entry->NumReferences += NumReferences;
+		Entry->LastUsed = ++UseClock;
+	}
+	return Entry;
+}
+
+UTexture2D* FGLTFTextureCache::AcquireByPath(const FString& PathKey, int32 NumReferences)
+{
+	FScopeLock Lock(&CriticalSection);
+	const FSHAHash* ContentHash = PathHashes.Find(PathKey);
+	FEntry* Entry = ContentHash ? AcquireEntry(*ContentHash, NumReferences) : nullptr;
+	return Entry ? Entry->Texture : nullptr;
+}
+
+UTexture2D* FGLTFTextureCache::AcquireByHash(const FSHAHash& ContentHash, const FString& PathKey, int32 NumReferences)
+{
+	FScopeLock Lock(&CriticalSection);
+	FEntry* Entry = AcquireEntry(ContentHash, NumReferences);
+	if (!Entry) return nullptr;
+	PathHashes.Add(PathKey, ContentHash);
+	return Entry->Texture;
+}
+
+UTexture2D* FGLTFTextureCache::Add(UTexture2D* Texture, const FSHAHash& ContentHash, const FString& PathKey, int64 SizeBytes, int32 NumReferences)
+{
+	check(IsInGameThread());
+
+	FScopeLock Lock(&CriticalSection);
+	PathHashes.Add(PathKey, ContentHash);
+	if (FEntry* Existing = AcquireEntry(ContentHash, NumReferences))
+	{
+		return Existing->Texture;
+	}
+
+	FEntry& Entry = Entries.Add(ContentHash);
+	Entry.Texture = Texture;
+	Entry.SizeBytes = SizeBytes;
+	Entry.NumReferences = NumReferences;
+	Entry.LastUsed = ++UseClock;
+	TextureHashes.Add(Texture, ContentHash);
+	CachedBytes += SizeBytes;
+	EvictTo(BudgetBytes);
+	return Texture;
+}
+
+bool FGLTFTextureCache::Release(UTexture2D* Texture)
+{
+	check(IsInGameThread());
+
+	FScopeLock Lock(&CriticalSection);
+	const FSHAHash* ContentHash = TextureHashes.Find(Texture);
+	if (!ContentHash) return false;
+
+	FEntry& Entry = Entries.FindChecked(*ContentHash);
+	Entry.NumReferences = FMath::Max(Entry.NumReferences - 1, 0);
+	if (Entry.NumReferences == 0)
+	{
+		EvictTo(BudgetBytes);
+	}
+	return true;
+}
+
+void FGLTFTextureCache::SetMemoryBudget(int64 NewBudgetBytes)
+{
+	FScopeLock Lock(&CriticalSection);
+	BudgetBytes = FMath::Max<int64>(NewBudgetBytes, 0);
+	EvictTo(BudgetBytes);
+}
+
+void FGLTFTextureCache::Trim()
+{
+	FScopeLock Lock(&CriticalSection);
+	EvictTo(0);
+}
+
+void FGLTFTextureCache::EvictTo(int64 MaxBytes)
+{
+	if (CachedBytes <= MaxBytes) return;
+
+	TArray<FSHAHash> Unreferenced;
+	for (const TPair<FSHAHash, FEntry>& Pair : Entries)
+	{
+		if (Pair.Value.NumReferences == 0) Unreferenced.Add(Pair.Key);
+	}
+	Unreferenced.Sort([this](const FSHAHash& A, const FSHAHash& B) { return Entries[A].LastUsed < Entries[B].LastUsed; });
+
+	// Evicted textures are left to the garbage collector, materials outside the cache may still draw them
+	for (const FSHAHash& ContentHash : Unreferenced)
+	{
+		if (CachedBytes <= MaxBytes) break;
+		const FEntry Entry = Entries.FindAndRemoveChecked(ContentHash);
+		TextureHashes.Remove(Entry.Texture);
+		CachedBytes -= Entry.SizeBytes;
+	}
+	for (auto It = PathHashes.CreateIterator(); It; ++It)
+	{
+		if (!Entries.Contains(It.Value())) It.RemoveCurrent();
+	}
+}
+
+void FGLTFTextureCache::AddReferencedObjects(FReferenceCollector& Collector)
+{
+	FScopeLock Lock(&CriticalSection);
+	for (TPair<FSHAHash, FEntry>& Pair : Entries)
+	{
+		Collector.AddReferencedObject(Pair.Value.Texture);
+	}
+}
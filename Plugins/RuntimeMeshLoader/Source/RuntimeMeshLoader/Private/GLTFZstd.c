@@ -0,0 +1,5 @@
+/*
+	Zstandard decompressor for supercompressed KTX2 levels, a single source file built as part of the module.
+	Kept in C, so it stays out of unity files and the engine's macros.
+*/
+#include "zstddeclib.c"
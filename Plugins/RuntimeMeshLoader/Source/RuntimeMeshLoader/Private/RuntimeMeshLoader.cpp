@@ -1,18 +1,23 @@
 // Copyright 1998-2017 Epic Games, Inc. All Rights Reserved.
 
 #include "RuntimeMeshLoader.h"
+#include "GLTFRuntimeImporter.h"
+#include "GLTFKTX2Texture.h"
 
 #define LOCTEXT_NAMESPACE "FRuntimeMeshLoaderModule"
 
 void FRuntimeMeshLoaderModule::StartupModule()
 {
 	// This code will execute after your module is loaded into memory; the exact timing is specified in the .uplugin file per-module
+	GLTFKTX2Texture::Initialize();
+	FAssimpImport::Startup();
 }
 
 void FRuntimeMeshLoaderModule::ShutdownModule()
 {
 	// This function may be called during shutdown to clean up your module.  For modules that support dynamic reloading,
 	// we call this function before unloading the module.
+	FAssimpImport::Shutdown();
 }
 
 #undef LOCTEXT_NAMESPACE
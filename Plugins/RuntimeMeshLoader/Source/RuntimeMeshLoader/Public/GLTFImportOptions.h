@@ -0,0 +1,127 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+/*
+	Assimp post-process pipelines.
+	Fast: triangulate and handedness only, normals are generated only if the file has none.
+	Balanced: smooth normals, UV generation, tangents and mesh merging, the plugin's historic behaviour.
+	Quality: Balanced plus vertex welding, cache locality, instance detection and invalid data cleanup.
+*/
+enum class EGLTFImportPreset : uint8
+{
+	Fast,
+	Balanced,
+	Quality
+};
+
+/*
+	Collision generated for imported meshes.
+	ConvexHulls: one convex hull per mesh, its points are picked on the import worker.
+	ComplexAsSimple: the render triangles are the collision, cooked asynchronously.
+*/
+enum class EGLTFCollisionMode : uint8
+{
+	None,
+	ConvexHulls,
+	ComplexAsSimple
+};
+
+/*
+	Effort spent per block when textures are compressed on the import workers.
+	Fast: bounding box endpoints, one ETC block split. Normal: principal axis endpoints, both ETC splits.
+	High: Normal plus least squares endpoint refinement and a wider ETC and EAC base search.
+*/
+enum class EGLTFTextureCompressionQuality : uint8
+{
+	Fast,
+	Normal,
+	High
+};
+
+/*
+	Per import settings, copied into the job when the load starts.
+*/
+struct FGLTFImportOptions
+{
+	EGLTFImportPreset Preset = EGLTFImportPreset::Balanced;
+
+	// Read the file first and drop steps whose output the file already has (normals, tangents, triangulation, UVs),
+	// or that nothing would use (tangents without normal maps).
+	bool bSkipRedundantSteps = true;
+
+	// aiPostProcessSteps bits added to / removed from the preset
+	uint32 ExtraPostProcessFlags = 0;
+	uint32 DisabledPostProcessFlags = 0;
+
+	// AI_CONFIG_PP_GSN_MAX_SMOOTHING_ANGLE and AI_CONFIG_PP_CT_MAX_SMOOTHING_ANGLE, in degrees
+	float NormalSmoothingAngle = 175.0f;
+	float TangentSmoothingAngle = 45.0f;
+
+	// Splits meshes into sections of bounded size and reorders their triangles for the post-transform vertex cache
+	// (aiProcess_SplitLargeMeshes and aiProcess_ImproveCacheLocality). ACMR before and after ends up in FGLTFRuntimeAsset::Stats.
+	bool bOptimizeForRendering = false;
+
+	// AI_CONFIG_PP_SLM_VERTEX_LIMIT / AI_CONFIG_PP_SLM_TRIANGLE_LIMIT. The vertex default keeps every section 16 bit indexable.
+	int32 MaxSectionVertices = 65535;
+	int32 MaxSectionTriangles = 1000000;
+
+	// AI_CONFIG_PP_ICL_PTCACHE_SIZE, also the cache size the ACMR stats are measured with
+	int32 VertexCacheSize = 12;
+
+	// Merges vertices closer than WeldPositionTolerance (in the units of the converted vertex data) whose normals, tangents,
+	// UVs and colors match as well, then drops triangles that collapsed. Meant for unindexed sources such as OBJ and STL,
+	// where every triangle brings its own three vertices. The reduction ends up in FGLTFRuntimeAsset::Stats.
+	bool bWeldVertices = false;
+	float WeldPositionTolerance = 0.001f;
+	float WeldNormalToleranceDegrees = 1.0f;
+	float WeldUVTolerance = 1.0e-4f;
+
+	// Builds simplified copies of every mesh on the import worker (quadric edge collapse) into FGLTFRuntimeAsset::MeshLODs.
+	// LODTriangleRatios are fractions of the full triangle count, LODScreenSizes the screen size below which each one is drawn.
+	bool bGenerateLODs = false;
+	TArray<float> LODTriangleRatios = { 0.5f, 0.25f, 0.1f };
+	TArray<float> LODScreenSizes = { 0.5f, 0.25f, 0.1f };
+
+	// Concatenates small meshes sharing a material into batches with instance transforms baked in, so a model made of
+	// many tiny parts draws with about one section per material. Batches keep a part table (FMeshInfo::Parts) for picking
+	// and have no LODs. Meshes placed several times stay instanced unless bMergeInstancedMeshes is set.
+	bool bMergeByMaterial = false;
+	bool bMergeInstancedMeshes = false;
+	int32 MaxMergePartVertices = 4096;
+	int32 MaxMergedVertices = 65536;
+	int32 MaxMergedTriangles = 262144;
+
+	EGLTFCollisionMode CollisionMode = EGLTFCollisionMode::None;
+
+	// Upper bound of the points kept per convex hull
+	int32 MaxHullVertices = 32;
+
+	// Builds the full mip chain of every texture on the import workers and uploads it with the top level.
+	// Color maps are filtered in linear space, normal maps renormalized.
+	bool bGenerateMips = true;
+
+	// Block compresses textures on the import workers, picking per texture role among the formats the GPU supports:
+	// BC1/BC3 on desktop, ETC2 (ETC1 for opaque textures on GLES2) on mobile. There are no BC7 or ASTC encoders, so textures stay
+	// uncompressed on GPUs with neither BC nor ETC support (e.g. ASTC only Metal devices), and when a side is not a multiple of 4.
+	bool bCompressTextures = false;
+	EGLTFTextureCompressionQuality TextureCompressionQuality = EGLTFTextureCompressionQuality::Normal;
+
+	// Normal maps as BC5, red and green only, for materials that rebuild the blue channel. Desktop only.
+	// Otherwise they get BC1 or ETC2 RGB like any opaque texture.
+	bool bTwoChannelNormalMaps = false;
+
+	// Meshes with fewer than 65536 vertices get 16 bit indices in FMeshInfo::Triangles16 instead of Triangles
+	bool bCompactIndices = false;
+
+	// When false vertices stay in mesh local (glTF) space and no per vertex transform pass runs.
+	// The node and basis transform then goes to FMeshInfo::RelativeTransform and FMeshInstance::Transform for the component to apply.
+	bool bBakeTransforms = true;
+
+	static FGLTFImportOptions FromPreset(EGLTFImportPreset NewPreset)
+	{
+		FGLTFImportOptions Options;
+		Options.Preset = NewPreset;
+		return Options;
+	}
+};
@@ -0,0 +1,25 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "PixelFormat.h"
+#include "GLTFTextureBuilder.h"
+
+/*
+	KTX2 images (KHR_texture_basisu), loaded straight into a GPU format without decoding to RGBA.
+	Block compressed payloads (BC, ETC2, ASTC) are uploaded as stored when the RHI supports them, after undoing
+	Zstandard or ZLIB supercompression. Basis Universal payloads (ETC1S, UASTC) are transcoded to the best format
+	the RHI supports, which needs the transcoder sources in ThirdParty/basis_universal/transcoder (WITH_BASIS_TRANSCODER).
+	Texels keep the channel order they were stored with.
+*/
+namespace GLTFKTX2Texture
+{
+	// Sets up the transcoder tables, called once on module startup
+	RUNTIMEMESHLOADER_API void Initialize();
+
+	// True if FileData starts with the KTX2 identifier
+	RUNTIMEMESHLOADER_API bool IsKTX2(const TArray<uint8>& FileData);
+
+	// Fills OutMips with every level of the KTX2 file FileData, largest first, in OutPixelFormat.
+	// ImageName is only used for logging. Safe to call off the game thread.
+	RUNTIMEMESHLOADER_API bool LoadKTX2(const TArray<uint8>& FileData, const FString& ImageName, EPixelFormat& OutPixelFormat, TArray<FGLTFTextureMip>& OutMips);
+}
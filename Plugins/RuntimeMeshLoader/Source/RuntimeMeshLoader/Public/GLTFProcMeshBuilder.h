@@ -0,0 +1,30 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GLTFRuntimeAsset.h"
+
+class UProceduralMeshComponent;
+
+/*
+	UProceduralMeshComponent sections made straight from FMeshInfo.
+	CreateMeshSection_LinearColor copies the streams into a temporary section and that once more into the component,
+	here the component's section is written directly. The overloads taking an rvalue FMeshInfo also free every source
+	stream as soon as it is converted, so at peak the source streams live next to the interleaved vertex buffer only.
+*/
+namespace GLTFProcMeshBuilder
+{
+	// Interleaves the streams of MeshInfo into a section, with the same defaults as UProceduralMeshComponent::CreateMeshSection
+	RUNTIMEMESHLOADER_API FProcMeshSection BuildSection(const FMeshInfo& MeshInfo, bool bCreateCollision);
+	RUNTIMEMESHLOADER_API FProcMeshSection BuildSection(FMeshInfo&& MeshInfo, bool bCreateCollision);
+
+	// Creates or replaces section SectionIndex of Component. Without collision the geometry is written into the component's
+	// section directly. With collision it goes through one temporary section, as cooking runs inside SetProcMeshSection.
+	// Game thread only.
+	RUNTIMEMESHLOADER_API void CreateMeshSection(UProceduralMeshComponent* Component, int32 SectionIndex, const FMeshInfo& MeshInfo, bool bCreateCollision);
+	RUNTIMEMESHLOADER_API void CreateMeshSection(UProceduralMeshComponent* Component, int32 SectionIndex, FMeshInfo&& MeshInfo, bool bCreateCollision);
+
+	// Swaps the geometry of section SectionIndex for MeshInfo without going through SetProcMeshSection, so collision is not cooked
+	// again and the section keeps its bounds. Meant for LODs of what the section holds. Creates the section, without collision,
+	// if it does not exist yet. Game thread only.
+	RUNTIMEMESHLOADER_API void UpdateMeshSection(UProceduralMeshComponent* Component, int32 SectionIndex, const FMeshInfo& MeshInfo);
+}
@@ -7,6 +7,9 @@
 #include "ImageCore.h"
 #include "Materials/MaterialInstanceDynamic.h"
 #include "Engine/Texture2D.h"
+#include "Misc/SecureHash.h"
+#include "GLTFImportOptions.h"
+#include "GLTFTextureCache.h"
 
 
 /*
@@ -14,12 +17,31 @@
 	Additional material has index that point to what mesh it is related. 
 */
 
+/*
+	Placement of one source mesh inside a merged FMeshInfo, for picking single parts out of a batch.
+*/
+struct FMergedPart
+{
+	FString Name;
+
+	int32 NodeIndex = INDEX_NONE; //Into FGLTFRuntimeAsset::Nodes
+
+	// Ranges in the batch's index and vertex lists
+	int32 FirstIndex = 0;
+	int32 NumIndices = 0;
+	int32 FirstVertex = 0;
+	int32 NumVertices = 0;
+};
+
 struct FMeshInfo
 {
 	TArray<FVector> Vertices;
 
 	TArray<int32> Triangles;
 
+	// Used instead of Triangles when FGLTFImportOptions::bCompactIndices is set and every index fits
+	TArray<uint16> Triangles16;
+
 	TArray<FVector> Normals;
 
 	TArray<FVector2D> UV0;
@@ -35,6 +57,126 @@ struct FMeshInfo
 	uint32 MaterialIndex;
 	
 	FString Name;
+
+	// Points whose convex hull is the mesh's simple collision, EGLTFCollisionMode::ConvexHulls only
+	TArray<FVector> ConvexHull;
+
+	// Hash of the geometry, hull points and collision mode, keys the cooked collision cache. Zero when collision is off.
+	FSHAHash CollisionHash;
+
+	// Only set on batches made by FGLTFImportOptions::bMergeByMaterial, ordered by FirstIndex
+	TArray<FMergedPart> Parts;
+
+	// Part a triangle of a merged batch came from, e.g. the FaceIndex of a hit result
+	int32 FindPart(int32 TriangleIndex) const
+	{
+		const int32 Index = TriangleIndex * 3;
+		int32 First = 0;
+		int32 Last = Parts.Num() - 1;
+		while (First <= Last)
+		{
+			const int32 Middle = (First + Last) / 2;
+			if (Index < Parts[Middle].FirstIndex) Last = Middle - 1;
+			else if (Index >= Parts[Middle].FirstIndex + Parts[Middle].NumIndices) First = Middle + 1;
+			else return Middle;
+		}
+		return INDEX_NONE;
+	}
+
+	// Bakes Transform into the vertex streams, normals use the inverse transpose
+	void TransformBy(const FTransform& Transform)
+	{
+		const FMatrix Matrix = Transform.ToMatrixWithScale();
+		const FMatrix NormalMatrix = Matrix.RemoveTranslation().Inverse().GetTransposed();
+		for (FVector& Vertex : Vertices)
+		{
+			Vertex = Matrix.TransformPosition(Vertex);
+		}
+		for (FVector& Normal : Normals)
+		{
+			Normal = NormalMatrix.TransformVector(Normal).GetSafeNormal();
+		}
+		for (FProcMeshTangent& Tangent : Tangents)
+		{
+			Tangent.TangentX = Matrix.TransformVector(Tangent.TangentX).GetSafeNormal();
+		}
+	}
+
+	int32 GetNumIndices() const { return Triangles16.Num() > 0 ? Triangles16.Num() : Triangles.Num(); }
+
+	// Moves Triangles into Triangles16 if every vertex can be addressed with 16 bits
+	bool NarrowIndices()
+	{
+		if (Triangles.Num() == 0 || Vertices.Num() > MAX_uint16 + 1) return false;
+		Triangles16.SetNumUninitialized(Triangles.Num());
+		for (int32 i = 0; i < Triangles.Num(); ++i)
+		{
+			Triangles16[i] = (uint16)Triangles[i];
+		}
+		Triangles.Empty();
+		return true;
+	}
+
+	// 32 bit index list whichever width was imported, for consumers such as UProceduralMeshComponent
+	TArray<int32> GetTriangles32() const
+	{
+		if (Triangles16.Num() == 0) return Triangles;
+		TArray<int32> Result;
+		Result.SetNumUninitialized(Triangles16.Num());
+		for (int32 i = 0; i < Triangles16.Num(); ++i)
+		{
+			Result[i] = Triangles16[i];
+		}
+		return Result;
+	}
+};
+
+/*
+	Simplified version of a FMeshInfo. LOD 0 is the FMeshInfo itself and is not stored again.
+*/
+struct FMeshLOD
+{
+	FMeshInfo Mesh;
+
+	// Drawn once the mesh covers less than this much of the screen, as in UStaticMesh LOD screen sizes
+	float ScreenSize = 0.0f;
+};
+
+/*
+	One placement of a FMeshInfo in the scene. Transform is applied on top of the mesh's vertex data,
+	so it is identity for meshes used by a single node, whose placement is baked in already.
+*/
+struct FMeshInstance
+{
+	int32 MeshIndex = INDEX_NONE;
+
+	FTransform Transform;
+
+	FString NodeName;
+
+	int32 NodeIndex = INDEX_NONE; //Into FGLTFRuntimeAsset::Nodes
+};
+
+/*
+	Scene node in the Unreal basis. Lets callers rebuild the hierarchy out of components
+	instead of relying on transforms baked into the vertices.
+*/
+struct FGLTFNode
+{
+	FString Name;
+
+	int32 ParentIndex = INDEX_NONE;
+
+	TArray<int32> Children;
+
+	// Meshes drawn by this node, into FGLTFRuntimeAsset::MeshInfo
+	TArray<int32> MeshIndices;
+
+	// Relative to the parent node
+	FTransform LocalTransform;
+
+	// Relative to the asset root
+	FTransform WorldTransform;
 };
 
 struct FImageInfo
@@ -45,7 +187,8 @@ struct FImageInfo
 	enum class EExtension
 	{
 		PNG,
-		JPEG
+		JPEG,
+		KTX2
 	};
 	EExtension ImageFormat;
 };
@@ -53,7 +196,10 @@ struct FImageInfo
 struct FTextureInfo
 {
 	FString Name;
-	int32 Source;
+	int32 Source = INDEX_NONE;
+
+	// The plain "source" image of a texture whose Source is a KHR_texture_basisu KTX2 image, used if that one cannot be loaded
+	int32 FallbackSource = INDEX_NONE;
 };
 
 struct FMaterialInfo
@@ -65,16 +211,16 @@ struct FMaterialInfo
 	{}
 
 	// PBR material inputs
-	int8 BaseColorIndex;
-	int8 MetallicRoughness;
+	int8 BaseColorIndex{ -1 };
+	int8 MetallicRoughness{ -1 };
 	FVector4 BaseColorFactor{ 1.0f, 1.0f, 1.0f, 1.0f };
 	float MetallicFactor{ 1.0f };
 	float RoughnessFactor{ 1.0f };
 
 	// base material inputs
-	int8 NormalIndex;
-	int8 OcclusionIndex;
-	int8 EmissiveIndex;
+	int8 NormalIndex{ -1 };
+	int8 OcclusionIndex{ -1 };
+	int8 EmissiveIndex{ -1 };
 	float NormalScale{ -1.0f };
 	float OcclusionStrength{ -1.0f };
 	FVector EmissiveFactor{ FVector::ZeroVector };
@@ -105,16 +251,89 @@ struct FAdditionalMaterial
 	TMap<int8, int8> MaterialMesh;
 };
 
+/*
+	Numbers gathered while importing, for profiling loads in the field.
+*/
+struct FGLTFImportStats
+{
+	// Meshes before and after aiProcess_SplitLargeMeshes
+	int32 NumMeshesBeforeSplit = 0;
+	int32 NumMeshesAfterSplit = 0;
+
+	// Average cache miss ratio (vertex shader runs per triangle) of a FIFO cache, before and after cache optimization.
+	// 0 when FGLTFImportOptions::bOptimizeForRendering is off.
+	float ACMRBefore = 0.0f;
+	float ACMRAfter = 0.0f;
+
+	// Mesh instances, so sections, before and after FGLTFImportOptions::bMergeByMaterial
+	int32 NumSectionsBeforeMerge = 0;
+	int32 NumSectionsAfterMerge = 0;
+
+	// Vertex count over all meshes before and after FGLTFImportOptions::bWeldVertices. Equal when welding is off.
+	int64 NumVerticesBeforeWeld = 0;
+	int64 NumVerticesAfterWeld = 0;
+};
+
 struct FGLTFRuntimeAsset
 {
 
 	TArray<FMeshInfo> MeshInfo;
+	TArray<FMeshInstance> MeshInstances; //Every aiMesh is converted once, nodes using it become instances
+	TArray<FGLTFNode> Nodes; //Depth first, parents always come before their children
+	TArray<TArray<FMeshLOD>> MeshLODs; //LOD 1 and up per MeshInfo entry, coarsest last. Empty unless LODs were generated.
 	TArray<UMaterialInstanceDynamic *> Materials;
 	TArray<UTexture2D*> Textures;
 	TArray<FAdditionalMaterial> AdditonalMaterials;
 
 	FString Name; //Name is equivalent to folder path from where asset was loaded
 	bool bSuccess = false;
+	FGLTFImportStats Stats;
+	EGLTFCollisionMode CollisionMode = EGLTFCollisionMode::None; //From the import options
+
+	// LOD of MeshInfo[MeshIndex] to draw at ScreenSize, 0 being MeshInfo itself
+	int32 SelectLOD(int32 MeshIndex, float ScreenSize) const
+	{
+		int32 LODIndex = 0;
+		if (MeshLODs.IsValidIndex(MeshIndex))
+		{
+			for (const FMeshLOD& LOD : MeshLODs[MeshIndex])
+			{
+				if (ScreenSize >= LOD.ScreenSize) break;
+				++LODIndex;
+			}
+		}
+		return LODIndex;
+	}
+
+	const FMeshInfo& GetLODMesh(int32 MeshIndex, int32 LODIndex) const
+	{
+		return LODIndex == 0 ? MeshInfo[MeshIndex] : MeshLODs[MeshIndex][LODIndex - 1].Mesh;
+	}
+
+	// Moves the geometry of MeshInfo[MeshIndex] out of the asset for a consumer that needs it only once, and drops its LODs.
+	// Material, name, transform, collision data and parts stay behind, the vertex and index streams are left empty.
+	FMeshInfo TakeMeshInfo(int32 MeshIndex)
+	{
+		FMeshInfo& Source = MeshInfo[MeshIndex];
+		FMeshInfo Taken = MoveTemp(Source);
+		Source.RelativeTransform = Taken.RelativeTransform;
+		Source.MaterialIndex = Taken.MaterialIndex;
+		Source.Name = Taken.Name;
+		Source.ConvexHull = Taken.ConvexHull;
+		Source.CollisionHash = Taken.CollisionHash;
+		Source.Parts = Taken.Parts;
+		if (MeshLODs.IsValidIndex(MeshIndex))
+		{
+			MeshLODs[MeshIndex].Empty();
+		}
+		return Taken;
+	}
+
+	// False once the geometry was taken by TakeMeshInfo
+	bool HasMeshData(int32 MeshIndex) const
+	{
+		return MeshInfo[MeshIndex].Vertices.Num() > 0;
+	}
     
     ~FGLTFRuntimeAsset()
     {
@@ -132,6 +351,9 @@ struct FGLTFRuntimeAsset
         Materials.Empty();
         for (auto Texture : Textures)
         {
+            // Cached textures can be shared with other assets, the cache decides when they go
+            if(!Texture || FGLTFTextureCache::Get().Release(Texture))
+                continue;
             if(Texture->IsValidLowLevel() && !Texture->IsPendingKillOrUnreachable())
             {
 
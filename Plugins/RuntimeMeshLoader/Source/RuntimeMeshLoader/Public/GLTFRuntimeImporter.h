@@ -2,104 +2,242 @@
 
 #pragma once
 #include "GLTFRuntimeAsset.h"
+#include "GLTFImportOptions.h"
 #include "RunnableThread.h"
 #include "ThreadSafeBool.h"
 #include "Runnable.h"
+#include "Event.h"
 #include "Async.h"
 #include "Materials/MaterialInstanceDynamic.h"
 #include "GLTFRuntimeImporter.generated.h"
 
 DECLARE_MULTICAST_DELEGATE_OneParam(FOnImportComplete, FGLTFRuntimeAsset *)
 
-class FAssimpImport : FRunnable
+enum class EAssimpImportPhase : uint8
+{
+	Read,
+	PostProcess,
+	Meshes,
+	Materials,
+	Done
+};
+
+struct FAssimpImportProgress
+{
+	FString FilePath;
+
+	EAssimpImportPhase Phase = EAssimpImportPhase::Read;
+
+	// Completion of the current phase and of the whole import, 0..1
+	float PhaseProgress = 0.0f;
+	float Progress = 0.0f;
+
+	// Wall time spent in every phase so far, indexed by EAssimpImportPhase
+	double PhaseSeconds[(int32)EAssimpImportPhase::Done] = {};
+};
+
+DECLARE_MULTICAST_DELEGATE_OneParam(FOnImportProgress, const FAssimpImportProgress&)
+
+enum class EAssimpImportPriority : uint8
+{
+	Low,
+	Normal,
+	High
+};
+
+/*
+	One queued import request. Jobs are shared between the caller's handle and the worker that runs them.
+*/
+class FAssimpImportJob : public TSharedFromThis<FAssimpImportJob, ESPMode::ThreadSafe>
 {
 public:
 
-	~FAssimpImport()
-	{
-		bRunning = false;
-		if (Thread){
-			delete Thread;
-			Thread = nullptr;
-		}
-	}
+	FAssimpImportJob(FString NewFilePath, const FGLTFImportOptions& NewOptions, FOnImportComplete NewOnImportComplete, FOnImportProgress NewOnImportProgress, EAssimpImportPriority NewPriority, uint64 NewSequence);
+
+	const FString& GetFilePath() const { return FilePath; }
+
+	const FGLTFImportOptions& GetOptions() const { return Options; }
+
+	EAssimpImportPriority GetPriority() const { return Priority; }
+
+	bool IsFinished() const { return bFinished; }
+
+	// Checked between import stages, a cancelled job stops at the next check and never broadcasts.
+	// Assimp cannot be interrupted, so a cancel during ReadFile or post-processing takes effect once that returns.
+	bool IsCancelled() const { return bCancelled; }
+
+	FGLTFRuntimeAsset * GetAsset() const { return IsFinished() ? GLTFAsset : nullptr; }
+
+	// Completion is broadcast on the game thread, so listeners can still be bound there after the job was queued
+	FOnImportComplete& GetOnImportComplete() { check(IsInGameThread()); return OnImportComplete; }
+
+	// Callable from any thread. Updates are throttled and broadcast on the game thread,
+	// phase changes and the final Done update are always delivered.
+	void ReportProgress(EAssimpImportPhase Phase, float PhaseFraction);
+
+private:
+
+	friend class FAssimpImport;
+
+	FString FilePath;
+
+	FGLTFImportOptions Options;
+
+	FOnImportComplete OnImportComplete;
+
+	FOnImportProgress OnImportProgress;
+
+	EAssimpImportPriority Priority;
+
+	// Submission order, keeps jobs of equal priority FIFO
+	uint64 Sequence;
+
+	FGLTFRuntimeAsset * GLTFAsset;
+
+	FThreadSafeBool bFinished;
+
+	FThreadSafeBool bCancelled;
+
+	FCriticalSection ProgressCriticalSection;
+
+	FAssimpImportProgress Progress;
+
+	double PhaseStartTime;
+
+	double LastProgressBroadcastTime;
+};
+
+typedef TSharedPtr<FAssimpImportJob, ESPMode::ThreadSafe> FAssimpImportJobPtr;
+
+class FAssimpImportWorker : public FRunnable
+{
+public:
+
+	FAssimpImportWorker(class FAssimpImport& InQueue, int32 WorkerIndex);
+
+	~FAssimpImportWorker();
 
 	// Begin FRunnable interface
 
 	virtual uint32 Run() override;
 
-	virtual void Stop() override
-	{
-		bRunning = false;
-		if (Thread) {
-			Thread->WaitForCompletion();
-		}
-	}
+	virtual void Stop() override { bRunning = false; }
 
-	virtual bool Init() override { return OnImportComplete.IsBound() && !FilePath.IsEmpty(); }
+	// End FRunnable interface
 
-	virtual void Exit() override
-	{
-		UE_LOG(LogTemp, Warning, TEXT("Exit geometry load."));
-
-		if (OnImportComplete.IsBound())
-			AsyncTask(ENamedThreads::GameThread, [&]()
-		{
-			OnImportComplete.Broadcast(GLTFAsset);
-			OnImportComplete.Clear();
-			Stop();
-		}
-		);
-	}
+	void WaitForCompletion();
 
-	// End FRunnable interface
+private:
+
+	class FAssimpImport& Queue;
+
+	FThreadSafeBool bRunning;
+
+	FRunnableThread* Thread;
+};
+
+/*
+	Import scheduler. Requests are queued by priority and picked up by a pool of worker threads,
+	completion delegates are always broadcast on the game thread.
+*/
+class FAssimpImport
+{
+public:
+
+	// Creates the scheduler and its workers. Called on module startup, on the game thread.
+	static void Startup();
 
-	bool IsRunning() const { return bRunning; }
+	// Only valid between Startup and Shutdown
+	static FAssimpImport& Get();
 
-	FOnImportComplete GetOnImportComplete() const { return OnImportComplete; }
+	static bool IsRunning() { return Instance != nullptr; }
 
-	void SetReadPath(FString NewFilePath) { FilePath = NewFilePath; }
+	// Stops all workers, pending jobs are dropped and running ones cancelled. Called on module shutdown.
+	static void Shutdown();
 
-	static void StartImport(FString NewFilePath, FOnImportComplete NewOnImportComplete, FGLTFRuntimeAsset * Asset = nullptr)
+	static FAssimpImportJobPtr StartImport(FString NewFilePath, FOnImportComplete NewOnImportComplete, EAssimpImportPriority Priority = EAssimpImportPriority::Normal,
+		FOnImportProgress NewOnImportProgress = FOnImportProgress(), const FGLTFImportOptions& Options = FGLTFImportOptions())
 	{
-		if(!Instance)
-			Instance = new FAssimpImport(NewFilePath, NewOnImportComplete);
- 		else
-		{	
-			Instance->FilePath = NewFilePath;
-			Instance->OnImportComplete = NewOnImportComplete;
-			Instance->Run();
-		}
+		return Get().EnqueueJob(NewFilePath, Options, NewOnImportComplete, NewOnImportProgress, Priority);
 	}
 
+	// Resizes the worker pool, running jobs are finished before their worker goes away.
+	void SetNumWorkers(int32 NumWorkers);
+
+	int32 GetNumWorkers() const { return Workers.Num(); }
+
+	int32 GetNumPendingJobs();
+
+	// Removes a queued job, or flags a running one so the worker abandons it
+	void CancelJob(const FAssimpImportJobPtr& Job);
+
+	void SetJobPriority(const FAssimpImportJobPtr& Job, EAssimpImportPriority NewPriority);
+
 private:
 
-	FAssimpImport(FString NewFilePath, FOnImportComplete NewOnImportComplete, FGLTFRuntimeAsset * Asset) :
-		bRunning(true),
-		FilePath(NewFilePath),
-		OnImportComplete(NewOnImportComplete),
-		GLTFAsset(Asset)
-	{
-		Thread = FRunnableThread::Create(this, TEXT("AssimpImport"));
-	}
+	friend class FAssimpImportWorker;
 
-	FAssimpImport(FString NewFilePath, FOnImportComplete NewOnImportComplete)
-		: FAssimpImport(NewFilePath, NewOnImportComplete, nullptr) {}
+	FAssimpImport();
 
-	FOnImportComplete OnImportComplete;
+	~FAssimpImport();
+
+	FAssimpImportJobPtr EnqueueJob(FString NewFilePath, const FGLTFImportOptions& Options, FOnImportComplete NewOnImportComplete, FOnImportProgress NewOnImportProgress, EAssimpImportPriority Priority);
+
+	// Pops the highest priority job, waits up to WaitMs for one to arrive.
+	FAssimpImportJobPtr DequeueJob(uint32 WaitMs);
+
+	void ExecuteJob(const FAssimpImportJobPtr& Job);
+
+	// Called by the worker once ExecuteJob returned
+	void FinishJob(const FAssimpImportJobPtr& Job);
+
+	void StopWorkers(int32 FirstWorker);
 
-	// Singleton instance
 	static FAssimpImport * Instance;
 
-	FGLTFRuntimeAsset * GLTFAsset;
+	TArray<FAssimpImportJobPtr> PendingJobs;
 
-	FString FilePath;
+	// Jobs a worker has dequeued and not finished yet
+	TArray<FAssimpImportJobPtr> RunningJobs;
 
-	FThreadSafeBool bRunning;
+	TArray<FAssimpImportWorker *> Workers;
 
-	FRunnableThread* Thread;
+	FCriticalSection QueueCriticalSection;
+
+	FEvent * WorkAvailableEvent;
 
-	FCriticalSection ImportCriticalSection;
+	uint64 NextSequence;
+};
+
+/*
+	Caller side of an import job returned by UGLTFRuntimeImporter::LoadAsset.
+	Default constructed handles are invalid and every call on them is a no-op.
+*/
+struct RUNTIMEMESHLOADER_API FGLTFImportHandle
+{
+	FGLTFImportHandle() {}
+
+	FGLTFImportHandle(FAssimpImportJobPtr InJob, class UGLTFRuntimeImporter* InImporter);
+
+	bool IsValid() const { return Job.IsValid(); }
+
+	bool IsFinished() const { return Job.IsValid() && Job->IsFinished(); }
+
+	bool IsCancelled() const { return Job.IsValid() && Job->IsCancelled(); }
+
+	EAssimpImportPriority GetPriority() const { return Job.IsValid() ? Job->GetPriority() : EAssimpImportPriority::Normal; }
+
+	// Also drops the job from the importer that started it, a cancelled job never reports back there
+	void Cancel();
+
+	// Only affects jobs still waiting in the queue
+	void SetPriority(EAssimpImportPriority NewPriority);
+
+private:
+
+	FAssimpImportJobPtr Job;
+
+	TWeakObjectPtr<class UGLTFRuntimeImporter> Importer;
 };
 
 UCLASS()
@@ -114,7 +252,14 @@ protected:
 
 	FString AssetFilePath;
 
-	void OnGeometryLoaded(FGLTFRuntimeAsset * Asset);
+	void OnGeometryLoaded(FGLTFRuntimeAsset * Asset, FString SourceFilePath, TWeakPtr<FAssimpImportJob, ESPMode::ThreadSafe> WeakJob);
+
+	void OnMaterialsLoaded(FGLTFRuntimeAsset * Asset, FAssimpImportJobPtr Job);
+
+	friend struct FGLTFImportHandle;
+
+	// Jobs started by this importer that have not reported back or been cancelled yet
+	TArray<FAssimpImportJobPtr> ActiveJobs;
 
 	UPROPERTY()
 	TArray<UMaterialInstanceDynamic *> Materials;
@@ -123,7 +268,10 @@ public:
 
 	FOnImportComplete OnImportComplete;
 
-	bool LoadAsset(FString Filepath);
+	// Snapshotted per LoadAsset call, so bind it before starting the load
+	FOnImportProgress OnImportProgress;
+
+	FGLTFImportHandle LoadAsset(FString Filepath, EAssimpImportPriority Priority = EAssimpImportPriority::Normal, const FGLTFImportOptions& Options = FGLTFImportOptions());
     
     void DestroyMaterials()
     {
@@ -10,7 +10,14 @@
 #include "Misc/FileHelper.h"
 #include "GLTFReader.h"
 #include "GLTFRuntimeAsset.h"
+#include "GLTFRuntimeImporter.h"
+#include "GLTFTextureCache.h"
+#include "GLTFTextureBuilder.h"
+#include "GLTFKTX2Texture.h"
 #include "ModuleManager.h"
+#include "Async/Async.h"
+#include "Async/ParallelFor.h"
+#include "HAL/ThreadSafeCounter.h"
 
 namespace GLTFRuntimeMaterials
 {
@@ -60,29 +67,53 @@ namespace GLTFRuntimeMaterials
 		return NewTexture;
 	}
 
-	UTexture2D * ImportTexture(UObject * Outer, FString ImageName)
+	// Pixels of one image file, decoded on a worker and uploaded on the game thread
+	struct FDecodedImage
+	{
+		FString Name;
+		EImageFormat Format = EImageFormat::Invalid;
+		EPixelFormat PixelFormat = EPixelFormat::PF_B8G8R8A8 /*EPixelFormat::PF_R8G8B8A8*/;
+
+		// Top level first, decoding fills only that one with the RGBA texels
+		TArray<FGLTFTextureMip> Mips;
+
+		// Mips came from a KTX2 file, all of them and already in PixelFormat
+		bool bFromKTX2 = false;
+	};
+
+	// Loads the compressed bytes of ImageName. Thread safe.
+	bool ReadImageFile(const FString& ImageName, TArray<uint8>& OutFileData)
 	{
 		if (!FPaths::FileExists(ImageName))
 		{
 			UE_LOG(LogTemp, Error, TEXT("File not found: %s"), *ImageName);
-			return nullptr;
+			return false;
 		}
 
-		// Load the compressed byte data from the file
-		TArray<uint8> FileData;
-		if (!FFileHelper::LoadFileToArray(FileData, *ImageName))
+		if (!FFileHelper::LoadFileToArray(OutFileData, *ImageName))
 		{
 			UE_LOG(LogTemp, Error, TEXT("Failed to load file: %s"), *ImageName);
-			return nullptr;
+			return false;
+		}
+		return true;
+	}
+
+	// Decompresses FileData, the content of ImageName. Thread safe, the ImageWrapper module has to be loaded on the game thread beforehand.
+	bool DecodeImageData(IImageWrapperModule& ImageWrapperModule, const TArray<uint8>& FileData, const FString& ImageName, FDecodedImage& OutImage)
+	{
+		if (GLTFKTX2Texture::IsKTX2(FileData))
+		{
+			OutImage.Name = TEXT("T_") + FPaths::GetBaseFilename(ImageName);
+			OutImage.bFromKTX2 = true;
+			return GLTFKTX2Texture::LoadKTX2(FileData, ImageName, OutImage.PixelFormat, OutImage.Mips);
 		}
 
 		// Detect the image type using the ImageWrapper module
-        IImageWrapperModule& ImageWrapperModule = FModuleManager::LoadModuleChecked<IImageWrapperModule>(TEXT("ImageWrapper"));
 		EImageFormat ImageFormat = ImageWrapperModule.DetectImageFormat(FileData.GetData(), FileData.Num());
 		if (ImageFormat == EImageFormat::Invalid)
 		{
 			UE_LOG(LogTemp, Error, TEXT("Unrecognized image file format: %s"), *ImageName);
-			return nullptr;
+			return false;
 		}
 
 		// Create an image wrapper for the detected image format
@@ -90,7 +121,7 @@ namespace GLTFRuntimeMaterials
 		if (!ImageWrapper.IsValid())
 		{
 			UE_LOG(LogTemp, Error, TEXT("Failed to create image wrapper for file: %s"), *ImageName);
-			return nullptr;
+			return false;
 		}
 
 		// Decompress the image data
@@ -101,13 +132,41 @@ namespace GLTFRuntimeMaterials
 		if (RawData == nullptr)
 		{
 			UE_LOG(LogTemp, Error, TEXT("Failed to decompress image file: %s"), *ImageName);
+			return false;
+		}
+
+		OutImage.Name = TEXT("T_") + FPaths::GetBaseFilename(ImageName);
+		OutImage.Format = ImageFormat;
+		OutImage.Mips.SetNum(1);
+		OutImage.Mips[0].SizeX = ImageWrapper->GetWidth();
+		OutImage.Mips[0].SizeY = ImageWrapper->GetHeight();
+		OutImage.Mips[0].Data = *RawData;
+		return true;
+	}
+
+	bool DecodeImage(IImageWrapperModule& ImageWrapperModule, const FString& ImageName, FDecodedImage& OutImage)
+	{
+		TArray<uint8> FileData;
+		return ReadImageFile(ImageName, FileData) && DecodeImageData(ImageWrapperModule, FileData, ImageName, OutImage);
+	}
+
+	// Uploads a decoded image. Game thread only.
+	UTexture2D* CreateTexture(const FDecodedImage& Image)
+	{
+		return GLTFTextureBuilder::CreateTexture(Image.Name, Image.PixelFormat, Image.Mips);
+	}
+
+	UTexture2D * ImportTexture(UObject * Outer, FString ImageName)
+	{
+		IImageWrapperModule& ImageWrapperModule = FModuleManager::LoadModuleChecked<IImageWrapperModule>(TEXT("ImageWrapper"));
+		FDecodedImage Image;
+		if (!DecodeImage(ImageWrapperModule, ImageName, Image))
+		{
 			return nullptr;
 		}
 
 		// Create the texture and upload the uncompressed image data
-		FString TextureBaseName = TEXT("T_") + FPaths::GetBaseFilename(ImageName);
-        auto NewTexture =  CreateTexture(Outer, *RawData, ImageFormat, ImageWrapper->GetWidth(), ImageWrapper->GetHeight(), EPixelFormat::PF_B8G8R8A8 /*EPixelFormat::PF_R8G8B8A8*/, FName(*TextureBaseName));
-        return NewTexture;
+		return CreateTexture(Image);
 	}
 
 	UMaterialInstanceDynamic * CreateNewMaterial(FString Name,bool Translusent)
@@ -332,26 +391,163 @@ namespace GLTFRuntimeMaterials
 		return NewMaterial;
 	}
     
-    //Importing the Asset materials parsing Asset
-	bool ImportMaterials(FGLTFRuntimeAsset * Asset, FString FilePath)
+	// Imports the materials of the glTF file at FilePath into Asset. The JSON is read and the textures read and decoded
+	// on the task graph, several images at once.
+	// Images go through FGLTFTextureCache, so one already imported by any asset is neither read nor decoded again.
+	// Each new texture is created on the game thread as soon as it is decoded, so decoded pixels do not pile up, and the
+	// materials follow once all of them exist. OnComplete runs on the game thread, with false if Job got cancelled on the way.
+	void ImportMaterialsAsync(FGLTFRuntimeAsset * Asset, FString FilePath, FAssimpImportJobPtr Job, TFunction<void(bool)> OnComplete)
 	{
-		GLTFReader Reader(Asset, FilePath);
-		FMaterialData MaterialData = Reader.GetMaterialData();
-		Asset->Textures.Reserve(MaterialData.Textures.Num());
-		Asset->Materials.Reserve(MaterialData.Materials.Num());
-		UE_LOG(LogTemp, Log, TEXT("MLARALOG: Materials json data read."));
-        for (auto Texture : MaterialData.Textures)
+		check(IsInGameThread());
+
+		IImageWrapperModule* ImageWrapperModule = &FModuleManager::LoadModuleChecked<IImageWrapperModule>(FName("ImageWrapper"));
+		AsyncTask(ENamedThreads::AnyBackgroundThreadNormalTask, [Asset, FilePath, Job, OnComplete, ImageWrapperModule]()
 		{
-			FString FolderPath = FPaths::GetPath(FilePath);
-			FString FileName = "/" + MaterialData.Images[Texture.Source].URI;
-            UE_LOG(LogTemp, Log, TEXT("Iterating"));
-            
-            Asset->Textures.Add(ImportTexture(BaseMaterial, FolderPath + FileName));
-		}
-		UE_LOG(LogTemp, Log, TEXT("MLARALOG: Textures created."));
-		for (auto Material : MaterialData.Materials)
-			Asset->Materials.Add(ImportMaterial(Material, Asset));
-		UE_LOG(LogTemp, Log, TEXT("MLARALOG: Materials created."));
-		return true;
+			// Nothing else sees the asset until OnComplete, the reader can fill its additional materials from here
+			GLTFReader Reader(Asset, FilePath);
+			TSharedPtr<FMaterialData, ESPMode::ThreadSafe> MaterialData = MakeShareable(new FMaterialData(Reader.GetMaterialData()));
+			UE_LOG(LogTemp, Log, TEXT("MLARALOG: Materials json data read."));
+
+			const int32 NumTextures = MaterialData->Textures.Num();
+			const int32 NumSteps = FMath::Max(NumTextures + MaterialData->Materials.Num(), 1);
+			const FString FolderPath = FPaths::GetPath(FilePath);
+			Asset->Textures.SetNumZeroed(NumTextures);
+			Asset->Materials.Reserve(MaterialData->Materials.Num());
+
+			// Texture entries sharing an image share its texture, every entry holds one cache reference
+			TArray<TArray<int32>> ImageTextures;
+			ImageTextures.SetNum(MaterialData->Images.Num());
+			// Plain image of a KHR_texture_basisu texture, loaded if its KTX2 image cannot be
+			TArray<int32> ImageFallbacks;
+			ImageFallbacks.Init(INDEX_NONE, MaterialData->Images.Num());
+			for (int32 TextureIndex = 0; TextureIndex < NumTextures; ++TextureIndex)
+			{
+				const int32 Source = MaterialData->Textures[TextureIndex].Source;
+				if (!ImageTextures.IsValidIndex(Source)) continue;
+				ImageTextures[Source].Add(TextureIndex);
+				if (ImageFallbacks[Source] == INDEX_NONE) ImageFallbacks[Source] = MaterialData->Textures[TextureIndex].FallbackSource;
+			}
+
+			// How each image gets filtered into mips, from the material inputs using it. Normal maps win over data, data over color.
+			TArray<EGLTFTextureRole> ImageRoles;
+			ImageRoles.Init(EGLTFTextureRole::Color, MaterialData->Images.Num());
+			auto SetRole = [&](int32 TextureIndex, EGLTFTextureRole Role)
+			{
+				if (!MaterialData->Textures.IsValidIndex(TextureIndex)) return;
+				const int32 Source = MaterialData->Textures[TextureIndex].Source;
+				if (ImageRoles.IsValidIndex(Source) && (uint8)Role > (uint8)ImageRoles[Source]) ImageRoles[Source] = Role;
+			};
+			for (const FMaterialInfo& Material : MaterialData->Materials)
+			{
+				SetRole(Material.MetallicRoughness, EGLTFTextureRole::Linear);
+				SetRole(Material.OcclusionIndex, EGLTFTextureRole::Linear);
+				SetRole(Material.NormalIndex, EGLTFTextureRole::Normal);
+			}
+			const FGLTFImportOptions Options = Job.IsValid() ? Job->GetOptions() : FGLTFImportOptions();
+
+			FGLTFTextureCache& Cache = FGLTFTextureCache::Get();
+			FThreadSafeCounter NumDecoded;
+			ParallelFor(ImageTextures.Num(), [&](int32 ImageIndex)
+			{
+				const TArray<int32>& TextureIndices = ImageTextures[ImageIndex];
+				if (TextureIndices.Num() == 0 || (Job.IsValid() && Job->IsCancelled())) return;
+
+				// Slots are written on the game thread only, in task order
+				auto AssignTexture = [Asset, TextureIndices](UTexture2D* Texture)
+				{
+					for (int32 TextureIndex : TextureIndices) Asset->Textures[TextureIndex] = Texture;
+				};
+
+				// The same file processed differently is a different texture, so the processing goes into both keys
+				const EGLTFTextureRole Role = ImageRoles[ImageIndex];
+				const uint32 Variant = (uint32)Role | (Options.bGenerateMips ? 0x10 : 0) | (Options.bCompressTextures ? 0x20 : 0)
+					| ((uint32)Options.TextureCompressionQuality << 6) | (Options.bTwoChannelNormalMaps ? 0x100 : 0);
+				const FString ImageName = FolderPath + "/" + MaterialData->Images[ImageIndex].URI;
+				const FString PathKey = FGLTFTextureCache::MakePathKey(ImageName) + FString::Printf(TEXT("|%x"), Variant);
+				UTexture2D* Cached = Cache.AcquireByPath(PathKey, TextureIndices.Num());
+				TArray<uint8> FileData;
+				FSHAHash ContentHash;
+				auto HashFileData = [&FileData, &ContentHash, Variant]()
+				{
+					FSHA1 HashState;
+					HashState.Update(FileData.GetData(), FileData.Num());
+					HashState.Update((const uint8*)&Variant, sizeof(Variant));
+					HashState.Final();
+					HashState.GetHash(ContentHash.Hash);
+				};
+				if (!Cached && ReadImageFile(ImageName, FileData))
+				{
+					HashFileData();
+					Cached = Cache.AcquireByHash(ContentHash, PathKey, TextureIndices.Num());
+				}
+
+				if (Cached)
+				{
+					AsyncTask(ENamedThreads::GameThread, [AssignTexture, Cached]() { AssignTexture(Cached); });
+				}
+				else
+				{
+					TSharedPtr<FDecodedImage, ESPMode::ThreadSafe> Image = MakeShareable(new FDecodedImage());
+					bool bDecoded = FileData.Num() > 0 && DecodeImageData(*ImageWrapperModule, FileData, ImageName, *Image);
+
+					// A KTX2 image this build or RHI cannot load is replaced by the texture's plain image, cached under the KTX2 keys
+					const int32 FallbackIndex = ImageFallbacks[ImageIndex];
+					if (!bDecoded && MaterialData->Images.IsValidIndex(FallbackIndex))
+					{
+						const FString FallbackName = FolderPath + "/" + MaterialData->Images[FallbackIndex].URI;
+						// The KTX2 file's hash already identifies the texture, unless it could not be read at all
+						const bool bHashFallback = FileData.Num() == 0;
+						*Image = FDecodedImage();
+						bDecoded = ReadImageFile(FallbackName, FileData) && DecodeImageData(*ImageWrapperModule, FileData, FallbackName, *Image);
+						if (bDecoded && bHashFallback) HashFileData();
+					}
+
+					if (bDecoded)
+					{
+						FileData.Empty();
+						if (!Image->bFromKTX2)
+						{
+							if (Options.bGenerateMips)
+							{
+								GLTFTextureBuilder::GenerateMips(Image->Mips, Role);
+							}
+							const EPixelFormat PixelFormat = GLTFTextureBuilder::SelectPixelFormat(Role, GLTFTextureBuilder::HasAlpha(Image->Mips[0]), Image->Mips[0].SizeX, Image->Mips[0].SizeY, Options);
+							if (PixelFormat != Image->PixelFormat && GLTFTextureBuilder::CompressMips(Image->Mips, PixelFormat, Options.TextureCompressionQuality))
+							{
+								Image->PixelFormat = PixelFormat;
+							}
+						}
+						AsyncTask(ENamedThreads::GameThread, [AssignTexture, Image, ContentHash, PathKey, TextureIndices]()
+						{
+							UTexture2D* NewTexture = CreateTexture(*Image);
+							if (NewTexture)
+							{
+								NewTexture = FGLTFTextureCache::Get().Add(NewTexture, ContentHash, PathKey, GLTFTextureBuilder::GetNumBytes(Image->Mips), TextureIndices.Num());
+							}
+							AssignTexture(NewTexture);
+						});
+					}
+				}
+				if (Job.IsValid()) Job->ReportProgress(EAssimpImportPhase::Materials, (float)(NumDecoded.Add(TextureIndices.Num()) + TextureIndices.Num()) / NumSteps);
+			});
+			UE_LOG(LogTemp, Log, TEXT("MLARALOG: Textures decoded."));
+
+			// Game thread tasks run in the order they were queued, so every texture exists by the time this one runs
+			AsyncTask(ENamedThreads::GameThread, [Asset, Job, OnComplete, MaterialData, NumTextures, NumSteps]()
+			{
+				const bool bCancelled = Job.IsValid() && Job->IsCancelled();
+				if (!bCancelled)
+				{
+					int32 Step = NumTextures;
+					for (const FMaterialInfo& Material : MaterialData->Materials)
+					{
+						if (Job.IsValid()) Job->ReportProgress(EAssimpImportPhase::Materials, (float)Step++ / NumSteps);
+						Asset->Materials.Add(ImportMaterial(Material, Asset));
+					}
+					UE_LOG(LogTemp, Log, TEXT("MLARALOG: Materials created."));
+				}
+				OnComplete(!bCancelled);
+			});
+		});
 	}
-};
+};
\ No newline at end of file
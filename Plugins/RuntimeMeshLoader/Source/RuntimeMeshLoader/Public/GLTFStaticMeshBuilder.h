@@ -0,0 +1,35 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GLTFRuntimeAsset.h"
+
+class UStaticMesh;
+class FStaticMeshRenderData;
+
+/*
+	Static mesh output for imported assets, an alternative to feeding UProceduralMeshComponent.
+	Render data is built straight from FMeshInfo, one transient UStaticMesh per mesh with its generated LODs,
+	so the meshes get engine LOD selection, instancing and static draw lists.
+*/
+namespace GLTFStaticMeshBuilder
+{
+	// Vertex, index and section buffers for MeshInfo[MeshIndex] and its LODs. Safe to call off the game thread.
+	RUNTIMEMESHLOADER_API TUniquePtr<FStaticMeshRenderData> BuildRenderData(const FGLTFRuntimeAsset& Asset, int32 MeshIndex);
+
+	// Wraps RenderData into a transient UStaticMesh and starts its render resources. Game thread only.
+	// bAllowCPUAccess keeps the buffers readable, which complex collision cooking needs.
+	RUNTIMEMESHLOADER_API UStaticMesh* CreateStaticMesh(UObject* Outer, TUniquePtr<FStaticMeshRenderData> RenderData, UMaterialInterface* Material, FName Name = NAME_None, bool bAllowCPUAccess = false);
+
+	// Builds render data for every mesh of Asset on a background thread, then creates the meshes on the game thread.
+	// OnComplete gets one mesh per FGLTFRuntimeAsset::MeshInfo entry and is not called if Outer is gone by then.
+	// Asset must stay alive until OnComplete runs.
+	RUNTIMEMESHLOADER_API void BuildStaticMeshesAsync(const FGLTFRuntimeAsset* Asset, UObject* Outer, TFunction<void(const TArray<UStaticMesh*>&)> OnComplete);
+
+	// Gives StaticMesh a body setup for Mode built from MeshInfo and cooks it asynchronously. A body setup cooked earlier for
+	// the same FMeshInfo::CollisionHash is reused as it is, so reloading a model skips cooking. OnReady runs on the game thread
+	// once the physics meshes exist, right away on a cache hit or for EGLTFCollisionMode::None.
+	RUNTIMEMESHLOADER_API void SetupCollision(UStaticMesh* StaticMesh, const FMeshInfo& MeshInfo, EGLTFCollisionMode Mode, TFunction<void()> OnReady);
+
+	// Releases every cached body setup
+	RUNTIMEMESHLOADER_API void ClearCollisionCache();
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "PixelFormat.h"
+#include "GLTFImportOptions.h"
+
+class UTexture2D;
+
+/*
+	How a texture's texels are filtered when its mips are built.
+	Color: sRGB encoded, averaged in linear space (base color, emissive).
+	Linear: averaged as they are (metallic roughness, occlusion).
+	Normal: tangent space normals, renormalized after averaging.
+*/
+enum class EGLTFTextureRole : uint8
+{
+	Color,
+	Linear,
+	Normal
+};
+
+struct FGLTFTextureMip
+{
+	int32 SizeX = 0;
+	int32 SizeY = 0;
+	TArray<uint8> Data;
+};
+
+/*
+	Texture data prepared on workers and uploaded in one go on the game thread.
+*/
+namespace GLTFTextureBuilder
+{
+	// Appends mips down to 1x1 to Mips, whose only entry is the 8 bit RGBA top level. 2x2 box filter following Role.
+	// Safe to call off the game thread.
+	RUNTIMEMESHLOADER_API void GenerateMips(TArray<FGLTFTextureMip>& Mips, EGLTFTextureRole Role);
+
+	// True if any texel of the 8 bit level Mip is not opaque
+	RUNTIMEMESHLOADER_API bool HasAlpha(const FGLTFTextureMip& Mip);
+
+	// Block compressed format for a texture of Role following Options and what the running RHI supports,
+	// PF_B8G8R8A8 when compression is off or nothing fits
+	RUNTIMEMESHLOADER_API EPixelFormat SelectPixelFormat(EGLTFTextureRole Role, bool bHasAlpha, int32 SizeX, int32 SizeY, const FGLTFImportOptions& Options);
+
+	// Encodes every 8 bit level of Mips into PixelFormat in place, false for formats there is no encoder for.
+	// Safe to call off the game thread.
+	RUNTIMEMESHLOADER_API bool CompressMips(TArray<FGLTFTextureMip>& Mips, EPixelFormat PixelFormat, EGLTFTextureCompressionQuality Quality);
+
+	// Transient texture holding every mip of Mips, uploaded with a single UpdateResource. Game thread only.
+	RUNTIMEMESHLOADER_API UTexture2D* CreateTexture(const FString& BaseName, EPixelFormat PixelFormat, const TArray<FGLTFTextureMip>& Mips);
+
+	// Bytes of all mips together
+	RUNTIMEMESHLOADER_API int64 GetNumBytes(const TArray<FGLTFTextureMip>& Mips);
+}
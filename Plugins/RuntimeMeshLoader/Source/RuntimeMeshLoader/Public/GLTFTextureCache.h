@@ -0,0 +1,80 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Misc/SecureHash.h"
+#include "UObject/GCObject.h"
+
+class UTexture2D;
+
+/*
+	Process wide cache of imported textures, so an image shared by several texture entries or several assets
+	is decoded and uploaded once. Textures are found by normalized path first, then by the SHA1 of the file content.
+	Every asset slot using a texture holds a reference. Unreferenced textures stay cached until the cache outgrows
+	its memory budget, the least recently used ones go first.
+*/
+class RUNTIMEMESHLOADER_API FGLTFTextureCache : public FGCObject
+{
+public:
+
+	static FGLTFTextureCache& Get();
+
+	// Normalized absolute path of an image plus its timestamp, so a file changed on disk is not served from the cache
+	static FString MakePathKey(const FString& ImagePath);
+
+	// Cached texture for PathKey with NumReferences added, null if there is none. Thread safe.
+	UTexture2D* AcquireByPath(const FString& PathKey, int32 NumReferences = 1);
+
+	// Cached texture with the same content, PathKey then finds it without reading the file. Thread safe.
+	UTexture2D* AcquireByHash(const FSHAHash& ContentHash, const FString& PathKey, int32 NumReferences = 1);
+
+	// Caches a texture just created from ContentHash with NumReferences. Returns the texture to use, which is the
+	// one already cached if another import got there first. Game thread only.
+	UTexture2D* Add(UTexture2D* Texture, const FSHAHash& ContentHash, const FString& PathKey, int64 SizeBytes, int32 NumReferences = 1);
+
+	// Drops one reference, false if Texture was not cached. Game thread only.
+	bool Release(UTexture2D* Texture);
+
+	void SetMemoryBudget(int64 NewBudgetBytes);
+
+	int64 GetMemoryBudget() const { return BudgetBytes; }
+
+	int64 GetCachedBytes() const { return CachedBytes; }
+
+	// Evicts every texture nothing references anymore
+	void Trim();
+
+	// Begin FGCObject interface
+	virtual void AddReferencedObjects(FReferenceCollector& Collector) override;
+	// End FGCObject interface
+
+private:
+
+	struct FEntry
+	{
+		UTexture2D* Texture = nullptr;
+		int64 SizeBytes = 0;
+		int32 NumReferences = 0;
+		uint64 LastUsed = 0;
+	};
+
+	FGLTFTextureCache() {}
+
+	FEntry* AcquireEntry(const FSHAHash& ContentHash, int32 NumReferences);
+
+	// Evicts unreferenced entries, least recently used first, until CachedBytes fits in MaxBytes
+	void EvictTo(int64 MaxBytes);
+
+	FCriticalSection CriticalSection;
+
+	TMap<FSHAHash, FEntry> Entries;
+
+	TMap<FString, FSHAHash> PathHashes;
+
+	TMap<UTexture2D*, FSHAHash> TextureHashes;
+
+	int64 BudgetBytes = 512 * 1024 * 1024;
+
+	int64 CachedBytes = 0;
+
+	uint64 UseClock = 0;
+};
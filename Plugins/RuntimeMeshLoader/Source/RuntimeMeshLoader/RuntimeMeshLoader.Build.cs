@@ -69,7 +69,8 @@ public class RuntimeMeshLoader : ModuleRules
 			{
 				"Slate",
 				"SlateCore",
-                "ImageWrapper"
+                "ImageWrapper",
+                "RenderCore"
 				// ... add private dependencies that you statically link with here ...	
 			}
 			);
@@ -81,6 +82,21 @@ public class RuntimeMeshLoader : ModuleRules
             }
             );
 
+        // Single file Zstandard decompressor, in ThirdParty/basis_universal/zstd where the transcoder looks for it.
+        // Always built, supercompressed KTX2 levels in a GPU format need it too.
+        PrivateIncludePaths.Add(Path.Combine(ThirdPartyPath, "basis_universal/zstd"));
+
+        // Basis Universal transcoder for KTX2 textures, compiled into the module when its sources are in ThirdParty/basis_universal/transcoder
+        string BasisTranscoderPath = Path.Combine(ThirdPartyPath, "basis_universal/transcoder");
+        bool bWithBasisTranscoder = File.Exists(Path.Combine(BasisTranscoderPath, "basisu_transcoder.cpp"));
+        PrivateDefinitions.Add("WITH_BASIS_TRANSCODER=" + (bWithBasisTranscoder ? "1" : "0"));
+        if (bWithBasisTranscoder)
+        {
+            PrivateIncludePaths.Add(BasisTranscoderPath);
+            // UASTC is usually Zstandard supercompressed
+            PrivateDefinitions.Add("BASISD_SUPPORT_KTX2_ZSTD=1");
+        }
+
         if ((Target.Platform == UnrealTargetPlatform.Win64) || (Target.Platform == UnrealTargetPlatform.Win32))
         {
             string PlatformString = (Target.Platform == UnrealTargetPlatform.Win64) ? "x64" : "x86";
@@ -8,7 +8,7 @@ public class AssimpLoader : ModuleRules
 	{
 		PCHUsage = PCHUsageMode.UseExplicitOrSharedPCHs;
 	
-		PublicDependencyModuleNames.AddRange(new string[] { "Core", "CoreUObject", "Engine", "InputCore", "RuntimeMeshLoader", "ProceduralMeshComponent" });
+		PublicDependencyModuleNames.AddRange(new string[] { "Core", "CoreUObject", "Engine", "InputCore", "RuntimeMeshLoader", "ProceduralMeshComponent", "RHI" });
 
 		PrivateDependencyModuleNames.AddRange(new string[] {  });
 
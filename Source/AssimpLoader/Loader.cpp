@@ -3,6 +3,26 @@
 #include "Loader.h"
 #include "Engine.h"
 #include "Async.h"
+#include "RHI.h"
+#include "GLTFStaticMeshBuilder.h"
+#include "GLTFProcMeshBuilder.h"
+
+// Frames skipped after switching output, while render resources settle
+static const int32 ComparisonWarmupFrames = 30;
+
+static void CompareOutputs(const TArray<FString>& Args, UWorld* World)
+{
+    const int32 NumFrames = Args.Num() > 0 ? FCString::Atoi(*Args[0]) : 300;
+    for (TActorIterator<ALoader> It(World); It; ++It)
+    {
+        It->CompareOutputModes(NumFrames);
+    }
+}
+
+static FAutoConsoleCommandWithWorldAndArgs CompareOutputsCommand(
+    TEXT("AssimpLoader.CompareOutputs"),
+    TEXT("Draws every loaded model with its output mode and with ProceduralMesh (StaticMesh if already procedural), logs frame time and draw calls. Args: [NumFrames]"),
+    FConsoleCommandWithWorldAndArgsDelegate::CreateStatic(&CompareOutputs));
 
 // Sets default values
 ALoader::ALoader()
@@ -11,7 +31,7 @@ ALoader::ALoader()
 	PrimaryActorTick.bCanEverTick = true;
     
     ProceduralMesh = CreateDefaultSubobject<UProceduralMeshComponent>(TEXT("GeneratedMesh"));
-    ProceduralMesh->bUseAsyncCooking = false;
+    ProceduralMesh->bUseAsyncCooking = true;
 }
 
 // Called when the game starts or when spawned
@@ -27,6 +47,12 @@ void ALoader::Tick(float DeltaTime)
 {
 	Super::Tick(DeltaTime);
 
+    if (bApplyQueued)
+        TickApply();
+    else if (OutputMode == EGLTFMeshOutput::ProceduralMesh)
+        UpdateLODs();
+    if (Comparison.Stage != 0)
+        TickComparison(DeltaTime);
 }
 
 void ALoader::LoadAssimpModel(FString Filepath)
@@ -42,22 +68,13 @@ void ALoader::LoadAssimpModel(FString Filepath)
 
 void ALoader::OnLoadComplete(FGLTFRuntimeAsset * LoadedAsset)
 {
-    int32 Index = 0;
     if(LoadedAsset)
     {
         if(LoadedAsset->bSuccess)
         {
-            for (auto MeshInfo : LoadedAsset->MeshInfo)
-            {
-                ProceduralMesh->CreateMeshSection_LinearColor(Index, MeshInfo.Vertices, MeshInfo.Triangles,
-                                                              MeshInfo.Normals, MeshInfo.UV0, MeshInfo.VertexColors, MeshInfo.Tangents, false);
-                {
-                    if (LoadedAsset->Materials.IsValidIndex(LoadedAsset->MeshInfo[Index].MaterialIndex))
-                        ProceduralMesh->SetMaterial(Index, LoadedAsset->Materials[LoadedAsset->MeshInfo[Index].MaterialIndex]);
-                }
-                Index++;
-                
-            }
+            CurrentAsset = LoadedAsset;
+            bMeshDataReleased = false;
+            BuildOutput();
             GEngine->AddOnScreenDebugMessage(-1, 10.f, FColor::Magenta, "Success");
         }
         else
@@ -66,3 +83,382 @@ void ALoader::OnLoadComplete(FGLTFRuntimeAsset * LoadedAsset)
     else
         GEngine->AddOnScreenDebugMessage(-1, 10.f, FColor::Magenta, "no loadedAsset");
 }
+
+void ALoader::BuildSection(int32 SectionIndex)
+{
+    const FLoaderSection& Section = Sections[SectionIndex];
+    const uint32 MaterialIndex = CurrentAsset->MeshInfo[Section.MeshIndex].MaterialIndex;
+    const bool bIdentity = Section.Transform.Equals(FTransform::Identity);
+
+    // Collision is cooked once, from LOD 0, by ApplyProceduralCollision. LOD switches after that swap the geometry in place,
+    // the cooked collision stays as it is.
+    if (!bApplyQueued)
+    {
+        if (bIdentity)
+            GLTFProcMeshBuilder::UpdateMeshSection(ProceduralMesh, SectionIndex, CurrentAsset->GetLODMesh(Section.MeshIndex, Section.LODIndex));
+        else
+        {
+            FMeshInfo MeshInfo = CurrentAsset->GetLODMesh(Section.MeshIndex, Section.LODIndex);
+            MeshInfo.TransformBy(Section.Transform);
+            GLTFProcMeshBuilder::UpdateMeshSection(ProceduralMesh, SectionIndex, MeshInfo);
+        }
+    }
+    else if (bReleaseMeshData && Section.bTakeMeshData && Section.LODIndex == 0)
+    {
+        FMeshInfo MeshInfo = CurrentAsset->TakeMeshInfo(Section.MeshIndex);
+        bMeshDataReleased = true;
+        if (!bIdentity)
+            MeshInfo.TransformBy(Section.Transform);
+        GLTFProcMeshBuilder::CreateMeshSection(ProceduralMesh, SectionIndex, MoveTemp(MeshInfo), false);
+    }
+    else if (bIdentity)
+        GLTFProcMeshBuilder::CreateMeshSection(ProceduralMesh, SectionIndex, CurrentAsset->GetLODMesh(Section.MeshIndex, Section.LODIndex), false);
+    else
+    {
+        FMeshInfo MeshInfo = CurrentAsset->GetLODMesh(Section.MeshIndex, Section.LODIndex);
+        MeshInfo.TransformBy(Section.Transform);
+        GLTFProcMeshBuilder::CreateMeshSection(ProceduralMesh, SectionIndex, MoveTemp(MeshInfo), false);
+    }
+    if (CurrentAsset->Materials.IsValidIndex(MaterialIndex))
+        ProceduralMesh->SetMaterial(SectionIndex, CurrentAsset->Materials[MaterialIndex]);
+}
+
+void ALoader::UpdateLODs()
+{
+    if (!CurrentAsset || bMeshDataReleased || CurrentAsset->MeshLODs.Num() == 0)
+        return;
+
+    APlayerCameraManager* Camera = UGameplayStatics::GetPlayerCameraManager(this, 0);
+    if (!Camera)
+        return;
+
+    // Same measure as ComputeBoundsScreenSize: projected sphere diameter over the screen width
+    const FVector ViewLocation = Camera->GetCameraLocation();
+    const float ScreenMultiple = 1.0f / FMath::Tan(FMath::DegreesToRadians(Camera->GetFOVAngle() * 0.5f));
+    const FTransform& ComponentTransform = ProceduralMesh->GetComponentTransform();
+    for (int32 Index = 0; Index < Sections.Num(); ++Index)
+    {
+        FLoaderSection& Section = Sections[Index];
+        if (Section.MeshIndex == INDEX_NONE)
+            continue;
+
+        const FBoxSphereBounds Bounds = Section.LocalBounds.TransformBy(ComponentTransform);
+        const float Distance = FMath::Max(FVector::Dist(Bounds.Origin, ViewLocation), 1.0f);
+        const float ScreenSize = ScreenMultiple * Bounds.SphereRadius / Distance;
+
+        const int32 LODIndex = CurrentAsset->SelectLOD(Section.MeshIndex, ScreenSize);
+        if (LODIndex != Section.LODIndex)
+        {
+            Section.LODIndex = LODIndex;
+            BuildSection(Index);
+        }
+    }
+}
+
+void ALoader::SetOutputMode(EGLTFMeshOutput NewMode)
+{
+    if (CurrentAsset && bMeshDataReleased)
+    {
+        UE_LOG(LogTemp, Warning, TEXT("SetOutputMode: mesh data of the loaded model was released, load it again to rebuild."));
+        return;
+    }
+    // The background build reads the asset's mesh data, a procedural rebuild could move it out from under it
+    if (PendingStaticBuilds > 0)
+    {
+        UE_LOG(LogTemp, Warning, TEXT("SetOutputMode: static meshes are still being built, try again once they are done."));
+        return;
+    }
+    OutputMode = NewMode;
+    if (CurrentAsset)
+        BuildOutput();
+}
+
+void ALoader::ClearOutput()
+{
+    ++OutputGeneration;
+    ProceduralMesh->ClearAllMeshSections();
+    ProceduralMesh->ClearCollisionConvexMeshes();
+    Sections.Reset();
+    for (UStaticMeshComponent* Component : StaticMeshComponents)
+    {
+        if (Component)
+            Component->DestroyComponent();
+    }
+    StaticMeshComponents.Reset();
+    OutputStaticMeshes.Reset();
+    PendingCollisionCooks = 0;
+    ApplyQueue.Reset();
+    ApplyCursor = 0;
+    ApplyFrames = 0;
+    ApplyMaxFrameMs = 0.0f;
+    bApplyQueued = false;
+}
+
+void ALoader::BuildOutput()
+{
+    ClearOutput();
+    const FGLTFRuntimeAsset* LoadedAsset = CurrentAsset;
+    bOutputPending = true;
+
+    if (OutputMode != EGLTFMeshOutput::ProceduralMesh)
+    {
+        // Render data is built on a background thread, components follow once it is done
+        const EGLTFMeshOutput RequestedMode = OutputMode;
+        ++PendingStaticBuilds;
+        GLTFStaticMeshBuilder::BuildStaticMeshesAsync(LoadedAsset, this, [this, LoadedAsset, RequestedMode](const TArray<UStaticMesh*>& StaticMeshes)
+        {
+            --PendingStaticBuilds;
+            if (LoadedAsset == CurrentAsset && OutputMode == RequestedMode)
+                OnStaticMeshesBuilt(StaticMeshes);
+        });
+        return;
+    }
+
+    // First instance of a mesh keeps section index == mesh index, additional instances go after the meshes
+    Sections.SetNum(LoadedAsset->MeshInfo.Num());
+    TArray<bool> bMeshPlaced;
+    bMeshPlaced.SetNumZeroed(LoadedAsset->MeshInfo.Num());
+    TArray<int32> LastSection;
+    LastSection.Init(INDEX_NONE, LoadedAsset->MeshInfo.Num());
+    for (const FMeshInstance& Instance : LoadedAsset->MeshInstances)
+    {
+        int32 Index = bMeshPlaced[Instance.MeshIndex] ? Sections.AddDefaulted() : Instance.MeshIndex;
+        bMeshPlaced[Instance.MeshIndex] = true;
+
+        FLoaderSection& Section = Sections[Index];
+        Section.MeshIndex = Instance.MeshIndex;
+        Section.Transform = Instance.Transform;
+        Section.LocalBounds = FBoxSphereBounds(LoadedAsset->MeshInfo[Instance.MeshIndex].Vertices.GetData(),
+                                               LoadedAsset->MeshInfo[Instance.MeshIndex].Vertices.Num()).TransformBy(Instance.Transform);
+        Section.LODIndex = 0;
+        ApplyQueue.Add([this, Index]() { BuildSection(Index); });
+        LastSection[Instance.MeshIndex] = Index;
+    }
+
+    // Sections are built in queue order, so the last one of each mesh can take its buffers
+    for (int32 Index : LastSection)
+    {
+        if (Index != INDEX_NONE)
+            Sections[Index].bTakeMeshData = true;
+    }
+    bApplyQueued = true;
+}
+
+void ALoader::OnStaticMeshesBuilt(const TArray<UStaticMesh*>& StaticMeshes)
+{
+    OutputStaticMeshes = StaticMeshes;
+    if (CurrentAsset->CollisionMode == EGLTFCollisionMode::None || StaticMeshes.Num() == 0)
+    {
+        QueueStaticMeshComponents();
+        ReleaseMeshData();
+        return;
+    }
+
+    // Components only register once their body setups are cooked, otherwise they would cook again on the game thread
+    PendingCollisionCooks = StaticMeshes.Num();
+    const int32 Generation = OutputGeneration;
+    for (int32 MeshIndex = 0; MeshIndex < StaticMeshes.Num(); ++MeshIndex)
+    {
+        TWeakObjectPtr<ALoader> WeakThis(this);
+        GLTFStaticMeshBuilder::SetupCollision(StaticMeshes[MeshIndex], CurrentAsset->MeshInfo[MeshIndex], CurrentAsset->CollisionMode, [WeakThis, Generation]()
+        {
+            ALoader* Loader = WeakThis.Get();
+            if (Loader && Loader->OutputGeneration == Generation && --Loader->PendingCollisionCooks == 0)
+                Loader->QueueStaticMeshComponents();
+        });
+    }
+    ReleaseMeshData();
+}
+
+void ALoader::ReleaseMeshData()
+{
+    // The render data owns its own copy by now, the asset's buffers are only dropped
+    if (!bReleaseMeshData)
+        return;
+    for (int32 MeshIndex = 0; MeshIndex < CurrentAsset->MeshInfo.Num(); ++MeshIndex)
+    {
+        CurrentAsset->TakeMeshInfo(MeshIndex);
+    }
+    bMeshDataReleased = true;
+}
+
+void ALoader::QueueStaticMeshComponents()
+{
+    const TArray<UStaticMesh*>& StaticMeshes = OutputStaticMeshes;
+
+    // Every FMeshInfo has a single material, so one component per mesh covers each mesh/material pair
+    TArray<TArray<FTransform>> InstanceTransforms;
+    InstanceTransforms.SetNum(StaticMeshes.Num());
+    for (const FMeshInstance& Instance : CurrentAsset->MeshInstances)
+    {
+        InstanceTransforms[Instance.MeshIndex].Add(Instance.Transform);
+    }
+
+    int32 NumInstanced = 0;
+    int32 NumComponents = 0;
+    for (int32 MeshIndex = 0; MeshIndex < StaticMeshes.Num(); ++MeshIndex)
+    {
+        const TArray<FTransform>& Transforms = InstanceTransforms[MeshIndex];
+        UStaticMesh* StaticMesh = StaticMeshes[MeshIndex];
+        if (OutputMode == EGLTFMeshOutput::InstancedStaticMesh && Transforms.Num() > 1)
+        {
+            ApplyQueue.Add([this, StaticMesh, Transforms]()
+            {
+                UHierarchicalInstancedStaticMeshComponent* Component = NewObject<UHierarchicalInstancedStaticMeshComponent>(this);
+                Component->SetupAttachment(ProceduralMesh);
+                Component->SetStaticMesh(StaticMesh);
+                for (const FTransform& Transform : Transforms)
+                {
+                    Component->AddInstance(Transform);
+                }
+                Component->RegisterComponent();
+                StaticMeshComponents.Add(Component);
+            });
+            NumInstanced += Transforms.Num();
+            ++NumComponents;
+            continue;
+        }
+
+        for (const FTransform& Transform : Transforms)
+        {
+            ApplyQueue.Add([this, StaticMesh, Transform]()
+            {
+                UStaticMeshComponent* Component = NewObject<UStaticMeshComponent>(this);
+                Component->SetupAttachment(ProceduralMesh);
+                Component->SetRelativeTransform(Transform);
+                Component->SetStaticMesh(StaticMesh);
+                Component->RegisterComponent();
+                StaticMeshComponents.Add(Component);
+            });
+            ++NumComponents;
+        }
+    }
+    UE_LOG(LogTemp, Log, TEXT("Static mesh output: %d components for %d instances, %d of them instanced"),
+           NumComponents, CurrentAsset->MeshInstances.Num(), NumInstanced);
+    bApplyQueued = true;
+}
+
+void ALoader::TickApply()
+{
+    const double StartTime = FPlatformTime::Seconds();
+    const double EndTime = StartTime + ApplyBudgetMs * 0.001;
+    while (ApplyCursor < ApplyQueue.Num())
+    {
+        ApplyQueue[ApplyCursor++]();
+        if (ApplyBudgetMs > 0.0f && FPlatformTime::Seconds() >= EndTime)
+            break;
+    }
+
+    ++ApplyFrames;
+    ApplyMaxFrameMs = FMath::Max(ApplyMaxFrameMs, (float)((FPlatformTime::Seconds() - StartTime) * 1000.0));
+    if (ApplyCursor < ApplyQueue.Num())
+        return;
+
+    const int32 NumSteps = ApplyQueue.Num();
+    UE_LOG(LogTemp, Log, TEXT("Model applied: %d steps over %d frames, max %.2f ms in one frame"), NumSteps, ApplyFrames, ApplyMaxFrameMs);
+    ApplyQueue.Reset();
+    ApplyCursor = 0;
+    bApplyQueued = false;
+    if (OutputMode == EGLTFMeshOutput::ProceduralMesh)
+        ApplyProceduralCollision();
+    bOutputPending = false;
+    OnModelApplied.Broadcast(NumSteps, ApplyFrames, ApplyMaxFrameMs);
+}
+
+void ALoader::ApplyProceduralCollision()
+{
+    const EGLTFCollisionMode CollisionMode = CurrentAsset->CollisionMode;
+    ProceduralMesh->bUseComplexAsSimpleCollision = CollisionMode == EGLTFCollisionMode::ComplexAsSimple;
+
+    if (CollisionMode == EGLTFCollisionMode::ConvexHulls)
+    {
+        TArray<TArray<FVector>> ConvexMeshes;
+        for (const FLoaderSection& Section : Sections)
+        {
+            if (Section.MeshIndex == INDEX_NONE)
+                continue;
+            TArray<FVector>& Hull = ConvexMeshes[ConvexMeshes.AddDefaulted()];
+            for (const FVector& Point : CurrentAsset->MeshInfo[Section.MeshIndex].ConvexHull)
+                Hull.Add(Section.Transform.TransformPosition(Point));
+        }
+        ProceduralMesh->SetCollisionConvexMeshes(ConvexMeshes);
+    }
+    else if (CollisionMode == EGLTFCollisionMode::ComplexAsSimple)
+    {
+        // Sections were created without collision. Enable it on all of them, then let a single section update cook everything.
+        int32 LastSection = INDEX_NONE;
+        for (int32 Index = 0; Index < ProceduralMesh->GetNumSections(); ++Index)
+        {
+            if (FProcMeshSection* ProcSection = ProceduralMesh->GetProcMeshSection(Index))
+            {
+                ProcSection->bEnableCollision = true;
+                LastSection = Index;
+            }
+        }
+        if (LastSection != INDEX_NONE)
+        {
+            const FProcMeshSection Section = *ProceduralMesh->GetProcMeshSection(LastSection);
+            ProceduralMesh->SetProcMeshSection(LastSection, Section);
+        }
+    }
+}
+
+void ALoader::CompareOutputModes(int32 NumFrames)
+{
+    if (!CurrentAsset)
+    {
+        UE_LOG(LogTemp, Warning, TEXT("CompareOutputModes: nothing loaded."));
+        return;
+    }
+    if (bMeshDataReleased)
+    {
+        UE_LOG(LogTemp, Warning, TEXT("CompareOutputModes: mesh data of the loaded model was released, load it again to compare."));
+        return;
+    }
+
+    // The current mode is measured first and restored at the end
+    Comparison = FOutputComparison();
+    Comparison.Stage = 1;
+    Comparison.NumFrames = FMath::Max(NumFrames, 1);
+    Comparison.FramesLeft = Comparison.NumFrames + ComparisonWarmupFrames;
+    Comparison.Modes[0] = OutputMode;
+    Comparison.Modes[1] = OutputMode == EGLTFMeshOutput::ProceduralMesh ? EGLTFMeshOutput::StaticMesh : EGLTFMeshOutput::ProceduralMesh;
+}
+
+void ALoader::TickComparison(float DeltaTime)
+{
+    if (bOutputPending || PendingStaticBuilds > 0)
+        return;
+
+    if (Comparison.FramesLeft-- > Comparison.NumFrames)
+        return;
+
+    // GNumDrawCallsRHI holds the previous frame's count
+    Comparison.FrameSeconds += DeltaTime;
+    Comparison.DrawCalls += GNumDrawCallsRHI;
+    if (Comparison.FramesLeft > 0)
+        return;
+
+    const int32 Slot = Comparison.Stage - 1;
+    Comparison.AverageFrameMs[Slot] = 1000.0 * Comparison.FrameSeconds / Comparison.NumFrames;
+    Comparison.AverageDrawCalls[Slot] = (float)Comparison.DrawCalls / Comparison.NumFrames;
+    Comparison.FrameSeconds = 0.0;
+    Comparison.DrawCalls = 0;
+
+    if (Comparison.Stage == 1)
+    {
+        Comparison.Stage = 2;
+        Comparison.FramesLeft = Comparison.NumFrames + ComparisonWarmupFrames;
+        SetOutputMode(Comparison.Modes[1]);
+        return;
+    }
+
+    const UEnum* ModeEnum = FindObject<UEnum>(ANY_PACKAGE, TEXT("EGLTFMeshOutput"), true);
+    for (int32 i = 0; i < 2; ++i)
+    {
+        UE_LOG(LogTemp, Log, TEXT("%s output: %.2f ms/frame, %.1f draw calls/frame over %d frames"),
+               *ModeEnum->GetNameStringByValue((int64)Comparison.Modes[i]), Comparison.AverageFrameMs[i], Comparison.AverageDrawCalls[i], Comparison.NumFrames);
+    }
+    Comparison.Stage = 0;
+    SetOutputMode(Comparison.Modes[0]);
+}
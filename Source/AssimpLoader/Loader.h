@@ -9,11 +9,50 @@
 #include "GLTFRuntimeAsset.h"
 
 #include "ProceduralMeshComponent.h"
+#include "Components/StaticMeshComponent.h"
+#include "Components/HierarchicalInstancedStaticMeshComponent.h"
 #include "Materials/MaterialInstanceDynamic.h"
 #include "Materials/MaterialInstance.h"
 
 #include "Loader.generated.h"
 
+UENUM(BlueprintType)
+enum class EGLTFMeshOutput : uint8
+{
+    // One procedural mesh section per instance, LODs swapped by rebuilding sections
+    ProceduralMesh,
+    // One transient UStaticMesh per mesh, built off the game thread, one component per instance
+    StaticMesh,
+    // As StaticMesh, but meshes placed more than once share one hierarchical instanced component
+    InstancedStaticMesh
+};
+
+// One procedural mesh section per mesh instance
+struct FLoaderSection
+{
+    int32 MeshIndex = INDEX_NONE;
+    FTransform Transform;
+    FBoxSphereBounds LocalBounds;
+    int32 LODIndex = 0;
+    bool bTakeMeshData = false; // Last section built from its mesh, may take the asset's buffers
+};
+
+// Frame time and draw calls gathered by ALoader::CompareOutputModes
+struct FOutputComparison
+{
+    int32 Stage = 0; // 0 idle, 1 and 2 measuring the first and second mode
+    int32 NumFrames = 0;
+    int32 FramesLeft = 0;
+    double FrameSeconds = 0.0;
+    int64 DrawCalls = 0;
+    float AverageFrameMs[2];
+    float AverageDrawCalls[2];
+    EGLTFMeshOutput Modes[2];
+};
+
+// Fired once every section or component of a loaded model exists. MaxFrameMs is the most a single frame spent applying.
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_ThreeParams(FOnModelApplied, int32, NumSteps, int32, NumFrames, float, MaxFrameMs);
+
 UCLASS()
 class ASSIMPLOADER_API ALoader : public AActor
 {
@@ -30,15 +69,88 @@ protected:
     UPROPERTY(VisibleAnywhere, BlueprintReadOnly)
     UProceduralMeshComponent * ProceduralMesh;
 
+    UPROPERTY(Transient)
+    TArray<UStaticMeshComponent*> StaticMeshComponents;
+
+    // Static mesh output, one per FMeshInfo
+    UPROPERTY(Transient)
+    TArray<UStaticMesh*> OutputStaticMeshes;
+
 public:	
 	// Called every frame
 	virtual void Tick(float DeltaTime) override;
 
 	UFUNCTION(BlueprintCallable)
     void LoadAssimpModel(FString Filepath);
+
+    // Which components loaded models are drawn with
+    UPROPERTY(EditAnywhere, BlueprintReadWrite)
+    EGLTFMeshOutput OutputMode = EGLTFMeshOutput::ProceduralMesh;
+
+    // Game thread milliseconds per frame spent creating sections, components and binding materials.
+    // At least one step runs every frame, 0 applies the whole model in one frame.
+    UPROPERTY(EditAnywhere, BlueprintReadWrite)
+    float ApplyBudgetMs = 4.0f;
+
+    UPROPERTY(BlueprintAssignable)
+    FOnModelApplied OnModelApplied;
+
+    // Moves mesh buffers out of the loaded asset into the output instead of copying them, so the geometry is held only once.
+    // The model can then not be rebuilt: LOD switching, SetOutputMode and CompareOutputModes do nothing until the next load.
+    UPROPERTY(EditAnywhere, BlueprintReadWrite)
+    bool bReleaseMeshData = false;
+
+    // Rebuilds the loaded model with NewMode. Does nothing while static meshes are still being built in the background.
+    UFUNCTION(BlueprintCallable)
+    void SetOutputMode(EGLTFMeshOutput NewMode);
+
+    // Draws the loaded model NumFrames frames with OutputMode, then with ProceduralMesh (StaticMesh if OutputMode is procedural),
+    // and logs average frame time and draw calls of both
+    UFUNCTION(BlueprintCallable)
+    void CompareOutputModes(int32 NumFrames = 300);
     
     //UFUNCTION()
     void OnLoadComplete(FGLTFRuntimeAsset * LoadedAsset);
 	
     UGLTFRuntimeImporter* Importer;
+
+private:
+    void ClearOutput();
+    void BuildOutput();
+    void BuildSection(int32 SectionIndex);
+    void OnStaticMeshesBuilt(const TArray<UStaticMesh*>& StaticMeshes);
+    void QueueStaticMeshComponents();
+
+    // Drops the loaded asset's geometry once the static meshes hold it, if bReleaseMeshData is set
+    void ReleaseMeshData();
+
+    // Procedural output collision, set up once every section exists
+    void ApplyProceduralCollision();
+    void TickComparison(float DeltaTime);
+
+    // Runs queued apply steps until ApplyBudgetMs is used up
+    void TickApply();
+
+    // Swaps section LODs by their screen size
+    void UpdateLODs();
+
+    FGLTFRuntimeAsset * CurrentAsset = nullptr;
+    TArray<FLoaderSection> Sections;
+    bool bOutputPending = false;
+    bool bMeshDataReleased = false;
+    FOutputComparison Comparison;
+
+    // Bumped by ClearOutput so callbacks of an older build can tell they are stale
+    int32 OutputGeneration = 0;
+    int32 PendingCollisionCooks = 0;
+
+    // BuildStaticMeshesAsync calls still reading mesh data in the background, SetOutputMode waits for them
+    int32 PendingStaticBuilds = 0;
+
+    // Section and component creation, spread over frames by TickApply
+    TArray<TFunction<void()>> ApplyQueue;
+    bool bApplyQueued = false;
+    int32 ApplyCursor = 0;
+    int32 ApplyFrames = 0;
+    float ApplyMaxFrameMs = 0.0f;
 };